@@ -0,0 +1,786 @@
+/*
+bench_roman_calc.c
+
+Benchmark program for the Roman numeral calculator library, libromancalc.
+
+This program times the conversion and arithmetic functions of the library and reports the average cost of each call in nanoseconds.  It is built once against each conversion engine ("make bench") so the speed of the engines can be compared alongside the static data sizes reported by the library build.
+
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_accumulator.h"
+#include "roman_stream.h"
+#include "roman_scan.h"
+#include "roman_sequence.h"
+#include "roman_intern.h"
+#include "roman_columns.h"
+#include "roman_arena.h"
+#include "roman_table.h"
+#include "roman_pipeline.h"
+
+//Name of the engine this benchmark was built against.
+#if defined(ROMAN_BRANCHLESS_ENGINE)
+#define ENGINE_NAME "branchless"
+#elif defined(ROMAN_COMPACT_ENGINE)
+#define ENGINE_NAME "compact"
+#else
+#define ENGINE_NAME "default"
+#endif
+
+//Number of passes over the full 1-3999 range for each benchmark.
+#define BENCH_PASSES 200
+
+//Sink for benchmark results, so the compiler cannot discard the calls
+//being timed.
+static volatile unsigned int bench_sink;
+
+/* Read the monotonic clock in nanoseconds. */
+static long long bench_now_ns(void) {
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Hardware counter of the branches mispredicted by this thread, or -1
+if the counter is not available (no PMU, or not permitted by
+perf_event_paranoid). */
+static int branch_miss_fd = -1;
+
+/* Open the branch miss counter, counting user space only. */
+static void bench_open_branch_misses(void) {
+
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	branch_miss_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/* Read the branch miss counter, or return -1 if it is not available. */
+static long long bench_branch_misses(void) {
+
+	long long count;
+
+	if(branch_miss_fd < 0 || read(branch_miss_fd, &count, sizeof(count)) != sizeof(count)) {
+		return -1;
+	}
+
+	return count;
+}
+
+/* Print one benchmark result line as the average time per call. */
+static void bench_report(const char * name, long long elapsed_ns, long long calls) {
+
+	printf("  %-28s %10.1f ns/op\n", name, (double)elapsed_ns / (double)calls);
+}
+
+/* Print one benchmark result line as the average time and branch
+misses per call. */
+static void bench_report_misses(const char * name, long long elapsed_ns, long long misses, long long calls) {
+
+	if(misses < 0) {
+		printf("  %-28s %10.1f ns/op   branch misses unavailable\n", name, (double)elapsed_ns / (double)calls);
+	}
+	else {
+		printf("  %-28s %10.1f ns/op %7.2f branch misses/op\n", name, (double)elapsed_ns / (double)calls, (double)misses / (double)calls);
+	}
+}
+
+/* Time convert_decimal_to_roman() over every valid decimal number. */
+static void bench_decimal_to_roman(void) {
+
+	char * numeral = allocate_roman_numeral_string();
+	long long start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+		for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+			convert_decimal_to_roman(i, numeral);
+			bench_sink += numeral[0];
+		}
+	}
+
+	bench_report("convert_decimal_to_roman", bench_now_ns() - start, (long long)BENCH_PASSES * MAX_DECIMAL);
+	free(numeral);
+}
+
+/* Time convert_roman_to_decimal() over every valid Roman numeral.  The
+numerals are generated up front so only the parse is timed. */
+static void bench_roman_to_decimal(void) {
+
+	char (*numerals)[sizeof(MAX_LENGTH_ROMAN)] = calloc(MAX_DECIMAL+1, sizeof(*numerals));
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(i, numerals[i]);
+	}
+
+	int decimal;
+	long long start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+		for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+			convert_roman_to_decimal(numerals[i], &decimal);
+			bench_sink += decimal;
+		}
+	}
+
+	bench_report("convert_roman_to_decimal", bench_now_ns() - start, (long long)BENCH_PASSES * MAX_DECIMAL);
+	free(numerals);
+}
+
+/* Time roman_addition() and roman_subtraction() on pairs of operands
+that always produce a valid result. */
+static void bench_arithmetic(void) {
+
+	char * numeral_a = allocate_roman_numeral_string();
+	char * numeral_b = allocate_roman_numeral_string();
+	char * numeral_result = allocate_roman_numeral_string();
+
+	convert_decimal_to_roman(1234, numeral_a);
+	convert_decimal_to_roman(567, numeral_b);
+
+	long long calls = (long long)BENCH_PASSES * MAX_DECIMAL;
+	long long start = bench_now_ns();
+
+	for(long long i=0; i<calls; i++) {
+		roman_addition(numeral_a, numeral_b, numeral_result);
+		bench_sink += numeral_result[0];
+	}
+
+	bench_report("roman_addition", bench_now_ns() - start, calls);
+
+	start = bench_now_ns();
+
+	for(long long i=0; i<calls; i++) {
+		roman_subtraction(numeral_a, numeral_b, numeral_result);
+		bench_sink += numeral_result[0];
+	}
+
+	bench_report("roman_subtraction", bench_now_ns() - start, calls);
+
+	free(numeral_a);
+	free(numeral_b);
+	free(numeral_result);
+}
+
+/* Time producing batches of 1024 numerals with a heap allocated string
+per result, freed at the end of each batch, against taking the strings
+from an arena that is reset after each batch. */
+static void bench_arena(void) {
+
+	const int batch = 1024;
+	const int batches = 2000;
+	char ** results = malloc(sizeof(char*) * batch);
+	long long start = bench_now_ns();
+
+	for(int b=0; b<batches; b++) {
+		for(int i=0; i<batch; i++) {
+			results[i] = allocate_roman_numeral_string();
+			convert_decimal_to_roman(i + 1, results[i]);
+		}
+		for(int i=0; i<batch; i++) {
+			bench_sink += results[i][0];
+			free(results[i]);
+		}
+	}
+
+	bench_report("batch, string per result", bench_now_ns() - start, (long long)batches * batch);
+
+	roman_arena * arena = allocate_roman_arena(batch);
+	start = bench_now_ns();
+
+	for(int b=0; b<batches; b++) {
+		for(int i=0; i<batch; i++) {
+			results[i] = (char*)roman_arena_decimal_to_roman(arena, i + 1);
+		}
+		for(int i=0; i<batch; i++) {
+			bench_sink += results[i][0];
+		}
+		roman_arena_reset(arena);
+	}
+
+	bench_report("batch, arena", bench_now_ns() - start, (long long)batches * batch);
+
+	free_roman_arena(arena);
+	free(results);
+}
+
+/* Draw an operand (1 to "limit") from one of the benchmark's operand
+distributions: 0 is uniform, 1 is small values (1-100), and 2 is
+log-uniform, which favours small values but covers the whole range. */
+static int bench_operand(int distribution, int limit, uint64_t * random_state) {
+
+	*random_state ^= *random_state << 13;
+	*random_state ^= *random_state >> 7;
+	*random_state ^= *random_state << 17;
+
+	double unit = (double)(*random_state >> 11) / 9007199254740992.0;
+	int value;
+
+	if(distribution == 0) {
+		value = (int)(unit * limit) + 1;
+	}
+	else if(distribution == 1) {
+		value = (int)(unit * 100) + 1;
+	}
+	else {
+		value = (int)exp(unit * log((double)limit));
+	}
+
+	return value < 1 ? 1 : (value > limit ? limit : value);
+}
+
+/* Time roman_addition() against addition through a result table
+mapped from a file, for several operand distributions.  Every sum is
+in range, so both paths do the full work. */
+static void bench_table(void) {
+
+	static const char * distribution_name[] = {"uniform", "small", "log-uniform"};
+	const char * path = "bench_roman_table.bin";
+	const int pairs = 1 << 16;
+	const int passes = 20;
+
+	long long start = bench_now_ns();
+	int written = roman_table_write(path);
+	long long write_ns = bench_now_ns() - start;
+
+	start = bench_now_ns();
+	roman_table * table = written == 0 ? roman_table_open(path) : NULL;
+	long long open_ns = bench_now_ns() - start;
+
+	if(table == NULL) {
+		printf("  result table unavailable\n");
+		return;
+	}
+
+	printf("  %-28s %10.1f us\n", "roman_table_write", write_ns / 1e3);
+	printf("  %-28s %10.1f us\n", "roman_table_open", open_ns / 1e3);
+
+	char (*operands)[ROMAN_NUMERAL_SIZE] = calloc(2 * pairs, sizeof(*operands));
+	char * numeral_sum = allocate_roman_numeral_string();
+	uint64_t random_state = 0x2545F4914F6CDD1DULL;
+	char name[64];
+
+	for(int distribution=0; distribution<3; distribution++) {
+
+		for(int i=0; i<pairs; i++) {
+			int decimal_a = bench_operand(distribution, MAX_DECIMAL - 1, &random_state);
+			int decimal_b = bench_operand(distribution, MAX_DECIMAL - decimal_a, &random_state);
+			convert_decimal_to_roman(decimal_a, operands[2*i]);
+			convert_decimal_to_roman(decimal_b, operands[2*i+1]);
+		}
+
+		start = bench_now_ns();
+		for(int pass=0; pass<passes; pass++) {
+			for(int i=0; i<pairs; i++) {
+				roman_addition(operands[2*i], operands[2*i+1], numeral_sum);
+				bench_sink += numeral_sum[0];
+			}
+		}
+		snprintf(name, sizeof(name), "add %s, compute", distribution_name[distribution]);
+		bench_report(name, bench_now_ns() - start, (long long)passes * pairs);
+
+		start = bench_now_ns();
+		for(int pass=0; pass<passes; pass++) {
+			for(int i=0; i<pairs; i++) {
+				roman_table_addition(table, operands[2*i], operands[2*i+1], numeral_sum);
+				bench_sink += numeral_sum[0];
+			}
+		}
+		snprintf(name, sizeof(name), "add %s, table", distribution_name[distribution]);
+		bench_report(name, bench_now_ns() - start, (long long)passes * pairs);
+	}
+
+	free(numeral_sum);
+	free(operands);
+	roman_table_close(table);
+	remove(path);
+}
+
+/* Pipeline callback for the benchmark: consume each result. */
+static void bench_pipeline_result(const roman_pipeline_output * outputs, size_t count, void * context) {
+
+	(void)context;
+
+	for(size_t i=0; i<count; i++) {
+		bench_sink += outputs[i].numeral[0];
+	}
+}
+
+/* Time a stream of mixed additions and subtractions computed inline
+with roman_addition() and roman_subtraction() against the same stream
+through a pipeline, for several batch sizes.  The pipeline is timed
+from start to finish, so thread startup and draining are included. */
+static void bench_pipeline(void) {
+
+	const size_t records = 1 << 20;
+	const size_t chunk = 4096;
+	static const size_t batch_sizes[] = {16, 256, 4096};
+	roman_pipeline_input * inputs = malloc(sizeof(roman_pipeline_input) * records);
+	char * numeral_result = allocate_roman_numeral_string();
+	uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+	char name[64];
+
+	for(size_t i=0; i<records; i++) {
+		int decimal_a = bench_operand(0, MAX_DECIMAL - 1, &random_state);
+		int decimal_b = bench_operand(0, MAX_DECIMAL - decimal_a, &random_state);
+		memset(&inputs[i], 0, sizeof(roman_pipeline_input));
+		convert_decimal_to_roman(decimal_a, inputs[i].numeral_a);
+		convert_decimal_to_roman(decimal_b, inputs[i].numeral_b);
+		inputs[i].operation = i % 2 ? ROMAN_PIPELINE_SUBTRACT : ROMAN_PIPELINE_ADD;
+	}
+
+	long long start = bench_now_ns();
+	for(size_t i=0; i<records; i++) {
+		if(inputs[i].operation == ROMAN_PIPELINE_ADD) {
+			roman_addition(inputs[i].numeral_a, inputs[i].numeral_b, numeral_result);
+		}
+		else {
+			roman_subtraction(inputs[i].numeral_a, inputs[i].numeral_b, numeral_result);
+		}
+		bench_sink += numeral_result[0];
+	}
+	bench_report("add/subtract, inline", bench_now_ns() - start, (long long)records);
+
+	for(size_t b=0; b<sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++) {
+
+		roman_pipeline_config config = {batch_sizes[b], 0, ROMAN_PIPELINE_BLOCK};
+
+		start = bench_now_ns();
+		roman_pipeline * pipeline = roman_pipeline_start(&config, bench_pipeline_result, NULL);
+
+		if(pipeline == NULL) {
+			printf("  pipeline unavailable\n");
+			break;
+		}
+
+		for(size_t i=0; i<records; i+=chunk) {
+			roman_pipeline_submit(pipeline, inputs + i, chunk, NULL);
+		}
+		roman_pipeline_finish(pipeline);
+
+		snprintf(name, sizeof(name), "add/subtract, pipeline %zu", batch_sizes[b]);
+		bench_report(name, bench_now_ns() - start, (long long)records);
+	}
+
+	free(numeral_result);
+	free(inputs);
+}
+
+/* Time a running total kept with roman_addition(total, x, total)
+against the same total kept in a roman_accumulator.  The total is
+rendered once per run of additions, as a caller reporting a final
+total would. */
+static void bench_running_total(void) {
+
+	//Add "X" 399 times per run, reaching MMMCMXC.
+	const int run_length = 399;
+	long long calls = (long long)BENCH_PASSES * MAX_DECIMAL;
+	long long runs = calls / run_length;
+
+	char * total = allocate_roman_numeral_string();
+	long long start = bench_now_ns();
+
+	for(long long run=0; run<runs; run++) {
+		strcpy(total, "X");
+		for(int i=1; i<run_length; i++) {
+			roman_addition(total, "X", total);
+		}
+		bench_sink += total[0];
+	}
+
+	bench_report("running total, addition", bench_now_ns() - start, runs * run_length);
+	free(total);
+
+	roman_accumulator * accumulator = allocate_roman_accumulator();
+	start = bench_now_ns();
+
+	for(long long run=0; run<runs; run++) {
+		roman_accumulator_reset(accumulator);
+		for(int i=0; i<run_length; i++) {
+			roman_accumulator_add_numeral(accumulator, "X");
+		}
+		bench_sink += roman_accumulator_numeral(accumulator)[0];
+	}
+
+	bench_report("running total, accumulator", bench_now_ns() - start, runs * run_length);
+	free_roman_accumulator(accumulator);
+}
+
+/* Time writing the numerals 1-3999 with roman_range(), to compare
+with a convert_decimal_to_roman() call for each. */
+static void bench_range(void) {
+
+	char * range = malloc((size_t)MAX_DECIMAL * ROMAN_NUMERAL_SIZE);
+	long long start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+		roman_range(MIN_DECIMAL, MAX_DECIMAL, range);
+		bench_sink += range[pass];
+	}
+
+	bench_report("roman_range, per numeral", bench_now_ns() - start, (long long)BENCH_PASSES * MAX_DECIMAL);
+	free(range);
+}
+
+/* Time summing a column of 1M numerals drawn from 64 distinct values,
+first by converting every row, then by dictionary-encoding the column
+and summing the ids.  The encoding time is included. */
+static void bench_intern(void) {
+
+	const size_t rows = 1 << 20;
+	char (*distinct)[ROMAN_NUMERAL_SIZE] = calloc(64, ROMAN_NUMERAL_SIZE);
+	const char ** column = malloc(rows * sizeof(char *));
+	uint16_t * ids = malloc(rows * sizeof(uint16_t));
+
+	for(int i=0; i<64; i++) {
+		convert_decimal_to_roman(1 + i * 37, distinct[i]);
+	}
+	for(size_t i=0; i<rows; i++) {
+		column[i] = distinct[(i * 2654435761u) >> 26 & 63];
+	}
+
+	long long sum = 0;
+	int decimal;
+	long long start = bench_now_ns();
+
+	for(size_t i=0; i<rows; i++) {
+		convert_roman_to_decimal(column[i], &decimal);
+		sum += decimal;
+	}
+
+	bench_report("column sum, parse each row", bench_now_ns() - start, rows);
+
+	roman_intern * table = allocate_roman_intern(64);
+	start = bench_now_ns();
+
+	roman_intern_encode(table, column, rows, ids);
+	roman_intern_sum(table, ids, rows, &sum);
+
+	bench_report("column sum, interned", bench_now_ns() - start, rows);
+	bench_sink += (int)sum;
+
+	free_roman_intern(table);
+	free(ids);
+	free(column);
+	free(distinct);
+}
+
+/* Time adding two columns of 64K random numerals with a
+roman_addition() call per row, then with roman_add_columns(), with and
+without rendering the results. */
+static void bench_columns(void) {
+
+	const size_t rows = 1 << 16;
+	char (*numerals)[ROMAN_NUMERAL_SIZE] = calloc(2 * rows, ROMAN_NUMERAL_SIZE);
+	const char ** column_a = malloc(rows * sizeof(char *));
+	const char ** column_b = malloc(rows * sizeof(char *));
+	uint8_t * validity = malloc(rows / 8);
+	int * decimal = malloc(rows * sizeof(int));
+	char * results = calloc(rows, ROMAN_NUMERAL_SIZE);
+
+	srand(1);
+	for(size_t i=0; i<rows; i++) {
+		convert_decimal_to_roman(rand() % 2000 + 1, numerals[2*i]);
+		convert_decimal_to_roman(rand() % 1999 + 1, numerals[2*i+1]);
+		column_a[i] = numerals[2*i];
+		column_b[i] = numerals[2*i+1];
+	}
+
+	long long start = bench_now_ns();
+
+	for(size_t i=0; i<rows; i++) {
+		roman_addition(column_a[i], column_b[i], results + i * ROMAN_NUMERAL_SIZE);
+	}
+
+	bench_report("add columns, per-row calls", bench_now_ns() - start, rows);
+
+	const int passes = 20;
+	start = bench_now_ns();
+
+	for(int pass=0; pass<passes; pass++) {
+		roman_add_columns(column_a, column_b, rows, validity, decimal, results);
+	}
+
+	bench_report("roman_add_columns", bench_now_ns() - start, (long long)passes * rows);
+
+	start = bench_now_ns();
+
+	for(int pass=0; pass<passes; pass++) {
+		roman_add_columns(column_a, column_b, rows, validity, decimal, NULL);
+	}
+
+	bench_report("roman_add_columns, decimal", bench_now_ns() - start, (long long)passes * rows);
+	bench_sink += decimal[rows-1] + results[0];
+
+	free(results);
+	free(decimal);
+	free(validity);
+	free(column_b);
+	free(column_a);
+	free(numerals);
+}
+
+/* Callback for the streaming parser benchmark. */
+static void bench_stream_token(int decimal, unsigned long long offset, int status, void * context) {
+
+	bench_sink += decimal + status;
+}
+
+/* Time the streaming parser over a buffer holding every numeral,
+separated by spaces and fed in 4 KB chunks, so many tokens are split
+across chunks. */
+static void bench_stream(void) {
+
+	const size_t chunk_size = 4096;
+	char * buffer = calloc(MAX_DECIMAL, sizeof(MAX_LENGTH_ROMAN));
+	size_t length = 0;
+
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(i, buffer + length);
+		length += strlen(buffer + length);
+		buffer[length++] = ' ';
+	}
+
+	roman_stream stream;
+	long long start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+
+		roman_stream_init(&stream);
+
+		for(size_t offset=0; offset<length; offset+=chunk_size) {
+			size_t chunk_length = length - offset < chunk_size ? length - offset : chunk_size;
+			roman_stream_feed(&stream, buffer + offset, chunk_length, bench_stream_token, NULL);
+		}
+
+		roman_stream_finish(&stream, bench_stream_token, NULL);
+	}
+
+	bench_report("roman_stream_feed, per token", bench_now_ns() - start, (long long)BENCH_PASSES * MAX_DECIMAL);
+	free(buffer);
+}
+
+/* Callback for the text scanner benchmark. */
+static int bench_scan_match(size_t offset, size_t length, int decimal, void * context) {
+
+	bench_sink += decimal;
+	return 0;
+}
+
+/* Time the text scanner over 16 MB of mostly non-Roman prose, with a
+numeral in about one sentence in eight, and report the throughput. */
+static void bench_scan(void) {
+
+	static const char * sentences[] = {
+		"The parties agree that the terms of this agreement shall be binding. ",
+		"Notwithstanding the foregoing, the licensee may terminate upon notice. ",
+		"All disputes will be resolved under the laws of the governing state. ",
+		"Payment is due within thirty days of the date of each invoice issued. ",
+		"Each party shall bear its own costs unless otherwise provided herein. ",
+		"The obligations in this section survive the expiry of the agreement. ",
+		"No waiver of any breach shall be deemed a waiver of any other breach. ",
+		"See Article XIV, Section III of the MCMXCVIII revision for details. "
+	};
+
+	const size_t length = 16 << 20;
+	char * text = malloc(length);
+	size_t filled = 0;
+
+	for(int i=0; filled<length; i++) {
+		const char * sentence = sentences[i % 8];
+		size_t sentence_length = strlen(sentence);
+		if(sentence_length > length - filled) {
+			sentence_length = length - filled;
+		}
+		memcpy(text + filled, sentence, sentence_length);
+		filled += sentence_length;
+	}
+
+	const int passes = 8;
+	long long start = bench_now_ns();
+
+	for(int pass=0; pass<passes; pass++) {
+		roman_scan(text, length, ROMAN_SCAN_UPPERCASE_ONLY, bench_scan_match, NULL);
+	}
+
+	long long elapsed = bench_now_ns() - start;
+
+	printf("  %-28s %10.2f GB/s\n", "roman_scan, prose", (double)length * passes / (double)elapsed);
+	free(text);
+}
+
+/* Time both conversions over every valid value in a shuffled order, so
+the values are as unpredictable as uniformly random input, and report
+the branches mispredicted per call. */
+static void bench_random_order(void) {
+
+	int * order = malloc(sizeof(int) * MAX_DECIMAL);
+	char (*numerals)[ROMAN_NUMERAL_SIZE] = calloc(MAX_DECIMAL, sizeof(*numerals));
+	char * numeral = allocate_roman_numeral_string();
+	uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+	for(int i=0; i<MAX_DECIMAL; i++) {
+		order[i] = i + MIN_DECIMAL;
+	}
+
+	//Fisher-Yates shuffle with a xorshift64 generator.
+	for(int i=MAX_DECIMAL-1; i>0; i--) {
+
+		random_state ^= random_state << 13;
+		random_state ^= random_state >> 7;
+		random_state ^= random_state << 17;
+
+		int j = (int)(random_state % (uint64_t)(i + 1));
+		int temp = order[i];
+		order[i] = order[j];
+		order[j] = temp;
+	}
+
+	for(int i=0; i<MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(order[i], numerals[i]);
+	}
+
+	const long long calls = (long long)BENCH_PASSES * MAX_DECIMAL;
+	long long misses = bench_branch_misses();
+	long long start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+		for(int i=0; i<MAX_DECIMAL; i++) {
+			convert_decimal_to_roman(order[i], numeral);
+			bench_sink += numeral[0];
+		}
+	}
+
+	long long elapsed = bench_now_ns() - start;
+	misses = misses < 0 ? -1 : bench_branch_misses() - misses;
+	bench_report_misses("decimal_to_roman, shuffled", elapsed, misses, calls);
+
+	misses = bench_branch_misses();
+	start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+		for(int i=0; i<MAX_DECIMAL; i++) {
+			convert_decimal_to_roman_slot(order[i], numerals[i]);
+			bench_sink += numerals[i][0];
+		}
+	}
+
+	elapsed = bench_now_ns() - start;
+	misses = misses < 0 ? -1 : bench_branch_misses() - misses;
+	bench_report_misses("decimal_to_roman_slot, shuf.", elapsed, misses, calls);
+
+	//Restore the numerals of "order" for the parse below.  
+	for(int i=0; i<MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(order[i], numerals[i]);
+	}
+
+	int decimal;
+	misses = bench_branch_misses();
+	start = bench_now_ns();
+
+	for(int pass=0; pass<BENCH_PASSES; pass++) {
+		for(int i=0; i<MAX_DECIMAL; i++) {
+			convert_roman_to_decimal(numerals[i], &decimal);
+			bench_sink += decimal;
+		}
+	}
+
+	elapsed = bench_now_ns() - start;
+	misses = misses < 0 ? -1 : bench_branch_misses() - misses;
+	bench_report_misses("roman_to_decimal, shuffled", elapsed, misses, calls);
+
+	free(numeral);
+	free(numerals);
+	free(order);
+}
+
+/* Time convert_roman_to_decimal() rejecting adversarial input: runs
+of one symbol, a longest valid numeral followed by more symbols, and
+non-numeral text, each from 16 bytes to 16 MB long.  The time per call
+should not grow with the length of the input. */
+static void bench_adversarial(void) {
+
+	static const char * kinds[] = {"M run", "long prefix", "text"};
+	const size_t max_length = 16 << 20;
+	const int calls = 1000000;
+
+	char * input = malloc(max_length + 1);
+	char name[64];
+	int decimal;
+
+	for(int kind=0; kind<3; kind++) {
+		for(size_t length=16; length<=max_length; length<<=10) {
+
+			if(kind == 0) {
+				memset(input, 'M', length);
+			}
+			else if(kind == 1) {
+				memset(input, 'I', length);
+				memcpy(input, MAX_LENGTH_ROMAN, strlen(MAX_LENGTH_ROMAN));
+			}
+			else {
+				memset(input, 'a', length);
+			}
+			input[length] = '\0';
+
+			long long start = bench_now_ns();
+
+			for(int i=0; i<calls; i++) {
+				bench_sink += convert_roman_to_decimal(input, &decimal);
+			}
+
+			if(length < 1024) {
+				snprintf(name, sizeof(name), "reject %s, %zu B", kinds[kind], length);
+			}
+			else {
+				snprintf(name, sizeof(name), "reject %s, %zu KB", kinds[kind], length >> 10);
+			}
+			bench_report(name, bench_now_ns() - start, calls);
+		}
+	}
+
+	free(input);
+}
+
+/* Run every benchmark for the engine this program was built against. */
+int main(void) {
+
+	printf("libromancalc benchmark, %s engine\n", ENGINE_NAME);
+
+	bench_open_branch_misses();
+
+	bench_decimal_to_roman();
+	bench_roman_to_decimal();
+	bench_random_order();
+	bench_adversarial();
+	bench_range();
+	bench_arithmetic();
+	bench_running_total();
+	bench_arena();
+	bench_table();
+	bench_pipeline();
+	bench_columns();
+	bench_intern();
+	bench_stream();
+	bench_scan();
+
+	return EXIT_SUCCESS;
+}
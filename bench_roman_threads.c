@@ -0,0 +1,347 @@
+/*
+bench_roman_threads.c
+
+Multi-threaded benchmark program for the Roman numeral calculator library, libromancalc.
+
+For each thread count (1, 2, 4, ... up to the requested maximum) this program pins one thread per CPU, round robin, and has every thread run a mixed workload of conversions, additions and subtractions for a fixed duration.  It reports the throughput and the scaling efficiency relative to one thread, latency percentiles (p50, p99, p99.9) for each operation, and the number of allocator calls made per operation.  The program is linked with "--wrap" for the allocator functions so calls made from within the library are counted.
+
+Usage: ./bench_roman_threads [max_threads] [seconds_per_step]
+
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "roman_numeral_calc.h"
+
+//Defaults for the command line arguments.
+#define DEFAULT_MAX_THREADS 32
+#define DEFAULT_SECONDS 1
+
+//Operations in the mixed workload, chosen at random for each call.
+enum {
+	OP_DECIMAL_TO_ROMAN,
+	OP_ROMAN_TO_DECIMAL,
+	OP_ADDITION,
+	OP_SUBTRACTION,
+	NUM_OPS
+};
+
+static const char * op_name[NUM_OPS] = {
+	"convert_decimal_to_roman",
+	"convert_roman_to_decimal",
+	"roman_addition",
+	"roman_subtraction"
+};
+
+/* Latency histograms are log-linear: values below 16 ns have their own
+bucket, and above that every power of two is split into 16 buckets, so
+each bucket is within about 6% of the values it holds. */
+#define HIST_SUB_BITS 4
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS 1024
+
+/* Per-thread allocator call counters, incremented by the wrappers
+below.  Each thread only reads and writes its own counter, so there is
+no contention added by the counting itself. */
+static __thread unsigned long long thread_alloc_calls;
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void * ptr, size_t size);
+void __real_free(void * ptr);
+
+void * __wrap_malloc(size_t size) {
+	thread_alloc_calls++;
+	return __real_malloc(size);
+}
+
+void * __wrap_calloc(size_t count, size_t size) {
+	thread_alloc_calls++;
+	return __real_calloc(count, size);
+}
+
+void * __wrap_realloc(void * ptr, size_t size) {
+	thread_alloc_calls++;
+	return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void * ptr) {
+	if(ptr != NULL) {
+		thread_alloc_calls++;
+	}
+	__real_free(ptr);
+}
+
+//Results gathered by each worker thread.
+typedef struct {
+	int cpu;
+	unsigned long long ops[NUM_OPS];
+	unsigned long long alloc_calls[NUM_OPS];
+	unsigned long long histogram[NUM_OPS][HIST_BUCKETS];
+} worker_result;
+
+//Numerals for every decimal number, generated before timing starts.
+static char numerals[MAX_DECIMAL+1][sizeof(MAX_LENGTH_ROMAN)];
+
+//State shared by the workers of one step.
+static pthread_barrier_t start_barrier;
+static int stop_flag;
+
+//Sink for benchmark results, so the compiler cannot discard the calls
+//being timed.
+static volatile int bench_sink;
+
+/* Read the monotonic clock in nanoseconds. */
+static inline uint64_t bench_now_ns(void) {
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Map a latency in nanoseconds to its histogram bucket. */
+static inline int hist_bucket(uint64_t ns) {
+
+	if(ns < HIST_SUB_COUNT) {
+		return (int)ns;
+	}
+
+	int shift = (63 - __builtin_clzll(ns)) - HIST_SUB_BITS;
+	int bucket = ((shift + 1) << HIST_SUB_BITS) + (int)((ns >> shift) & (HIST_SUB_COUNT - 1));
+
+	return bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1;
+}
+
+/* Lowest latency, in nanoseconds, held by a histogram bucket. */
+static uint64_t hist_bucket_value(int bucket) {
+
+	if(bucket < HIST_SUB_COUNT) {
+		return (uint64_t)bucket;
+	}
+
+	int shift = (bucket >> HIST_SUB_BITS) - 1;
+
+	return (uint64_t)(HIST_SUB_COUNT + (bucket & (HIST_SUB_COUNT - 1))) << shift;
+}
+
+/* Find the latency at a percentile (0-100) of a histogram. */
+static uint64_t hist_percentile(const unsigned long long * histogram, double percentile) {
+
+	unsigned long long total = 0;
+	for(int i=0; i<HIST_BUCKETS; i++) {
+		total += histogram[i];
+	}
+
+	if(total == 0) {
+		return 0;
+	}
+
+	unsigned long long rank = (unsigned long long)(percentile / 100.0 * (double)(total - 1));
+	unsigned long long seen = 0;
+
+	for(int i=0; i<HIST_BUCKETS; i++) {
+		seen += histogram[i];
+		if(seen > rank) {
+			return hist_bucket_value(i);
+		}
+	}
+
+	return hist_bucket_value(HIST_BUCKETS - 1);
+}
+
+/* Small per-thread random number generator (xorshift64). */
+static inline uint64_t next_random(uint64_t * state) {
+
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+
+	return x;
+}
+
+/* Worker thread.  Pins itself to its CPU, waits for the other workers,
+then runs random operations until the stop flag is set. */
+static void * worker_main(void * arg) {
+
+	worker_result * result = (worker_result*)arg;
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(result->cpu, &cpus);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+	char numeral_result[sizeof(MAX_LENGTH_ROMAN)] = {'\0'};
+	uint64_t random_state = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)result->cpu << 32) ^ (uint64_t)(uintptr_t)result;
+	int decimal;
+
+	pthread_barrier_wait(&start_barrier);
+
+	while(!__atomic_load_n(&stop_flag, __ATOMIC_RELAXED)) {
+
+		uint64_t random = next_random(&random_state);
+		int op = (int)(random & 3);
+		int decimal_a = (int)((random >> 8) % (MAX_DECIMAL - 1)) + 2;
+		int decimal_b = (int)((random >> 32) % (decimal_a - 1)) + 1;
+
+		//Keep sums in range, so additions take the full path.
+		if(op == OP_ADDITION && decimal_a + decimal_b > MAX_DECIMAL) {
+			decimal_a = MAX_DECIMAL - decimal_b;
+		}
+
+		unsigned long long alloc_before = thread_alloc_calls;
+		uint64_t start = bench_now_ns();
+
+		switch(op) {
+		case OP_DECIMAL_TO_ROMAN:
+			convert_decimal_to_roman(decimal_a, numeral_result);
+			break;
+		case OP_ROMAN_TO_DECIMAL:
+			convert_roman_to_decimal(numerals[decimal_a], &decimal);
+			numeral_result[0] = (char)decimal;
+			break;
+		case OP_ADDITION:
+			roman_addition(numerals[decimal_a], numerals[decimal_b], numeral_result);
+			break;
+		default:
+			roman_subtraction(numerals[decimal_a], numerals[decimal_b], numeral_result);
+			break;
+		}
+
+		uint64_t elapsed = bench_now_ns() - start;
+
+		result->alloc_calls[op] += thread_alloc_calls - alloc_before;
+		result->histogram[op][hist_bucket(elapsed)]++;
+		result->ops[op]++;
+		bench_sink += numeral_result[0];
+	}
+
+	return NULL;
+}
+
+/* Run one step of the benchmark with "num_threads" workers for
+"seconds".  Returns the throughput in operations per second and merges
+the workers' results into "total". */
+static double run_step(int num_threads, int seconds, int num_cpus, worker_result * total) {
+
+	pthread_t * threads = malloc(sizeof(pthread_t) * num_threads);
+	worker_result * results = calloc(num_threads, sizeof(worker_result));
+
+	pthread_barrier_init(&start_barrier, NULL, num_threads + 1);
+	__atomic_store_n(&stop_flag, 0, __ATOMIC_RELAXED);
+
+	for(int i=0; i<num_threads; i++) {
+		results[i].cpu = i % num_cpus;
+		pthread_create(&threads[i], NULL, worker_main, &results[i]);
+	}
+
+	pthread_barrier_wait(&start_barrier);
+	uint64_t start = bench_now_ns();
+
+	sleep(seconds);
+	__atomic_store_n(&stop_flag, 1, __ATOMIC_RELAXED);
+
+	for(int i=0; i<num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	uint64_t elapsed = bench_now_ns() - start;
+	pthread_barrier_destroy(&start_barrier);
+
+	unsigned long long ops = 0;
+	memset(total, 0, sizeof(worker_result));
+
+	for(int i=0; i<num_threads; i++) {
+		for(int op=0; op<NUM_OPS; op++) {
+			total->ops[op] += results[i].ops[op];
+			total->alloc_calls[op] += results[i].alloc_calls[op];
+			for(int b=0; b<HIST_BUCKETS; b++) {
+				total->histogram[op][b] += results[i].histogram[op][b];
+			}
+			ops += results[i].ops[op];
+		}
+	}
+
+	free(threads);
+	free(results);
+
+	return (double)ops * 1e9 / (double)elapsed;
+}
+
+/* Estimate the cost of the two clock reads around every operation, so
+it can be kept in mind when reading the latencies. */
+static uint64_t timer_overhead_ns(void) {
+
+	const int samples = 100000;
+	uint64_t start = bench_now_ns();
+
+	for(int i=0; i<samples; i++) {
+		bench_sink += (int)bench_now_ns();
+	}
+
+	return (bench_now_ns() - start) / samples;
+}
+
+/* Run the benchmark for 1, 2, 4, ... threads up to the maximum. */
+int main(int argc, char ** argv) {
+
+	int max_threads = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+	int seconds = argc > 2 ? atoi(argv[2]) : DEFAULT_SECONDS;
+	int num_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+	if(max_threads < 1 || seconds < 1 || num_cpus < 1) {
+		fprintf(stderr, "usage: %s [max_threads] [seconds_per_step]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(i, numerals[i]);
+	}
+
+	printf("libromancalc thread scaling benchmark\n");
+	printf("  %d online CPUs, %d s per step, timer overhead ~%llu ns per operation\n\n",
+		num_cpus, seconds, (unsigned long long)timer_overhead_ns());
+
+	worker_result * total = malloc(sizeof(worker_result));
+	double single_thread_rate = 0.0;
+
+	for(int num_threads=1; num_threads<=max_threads; num_threads*=2) {
+
+		double rate = run_step(num_threads, seconds, num_cpus, total);
+		if(num_threads == 1) {
+			single_thread_rate = rate;
+		}
+
+		double efficiency = rate / (single_thread_rate * num_threads);
+
+		printf("threads %2d: %10.3f Mops/s, scaling efficiency %5.1f%%\n",
+			num_threads, rate / 1e6, efficiency * 100.0);
+		printf("  %-26s %12s %8s %8s %8s %11s\n", "operation", "ops", "p50 ns", "p99 ns", "p99.9 ns", "allocs/op");
+
+		for(int op=0; op<NUM_OPS; op++) {
+			printf("  %-26s %12llu %8llu %8llu %8llu %11.2f\n",
+				op_name[op], total->ops[op],
+				(unsigned long long)hist_percentile(total->histogram[op], 50.0),
+				(unsigned long long)hist_percentile(total->histogram[op], 99.0),
+				(unsigned long long)hist_percentile(total->histogram[op], 99.9),
+				total->ops[op] ? (double)total->alloc_calls[op] / (double)total->ops[op] : 0.0);
+		}
+
+		printf("\n");
+	}
+
+	free(total);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+/*
+roman_accumulator.h
+
+Header file for the running total accumulator of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_ACCUMULATOR_H
+#define ROMAN_ACCUMULATOR_H
+
+/* A running Roman numeral total.  The accumulator keeps its total as a
+decimal number, so adding to or subtracting from it only parses the
+operand, rather than re-parsing and re-rendering the whole total as
+repeated roman_addition() calls would.  The total is rendered as Roman
+numerals only when requested, and the rendering is cached until the
+total changes.  The structure is opaque; use the functions below. */
+typedef struct roman_accumulator roman_accumulator;
+
+/* Allocates an accumulator with a total of zero.  Zero has no Roman
+numeral, so the first operation should be an addition.  Returns NULL
+if the allocation fails.  Be sure to release the accumulator with
+free_roman_accumulator() when done. */
+roman_accumulator * allocate_roman_accumulator();
+
+/* Releases an accumulator allocated by allocate_roman_accumulator().
+Passing NULL has no effect. */
+void free_roman_accumulator(roman_accumulator * accumulator);
+
+/* Add a Roman numeral, or a decimal number (1-3999), to the total.
+The new total must be less than or equal to 3999.  A '0' value is
+returned if the addition succeeds.  A '1' value is returned if the
+addition fails, either due to invalid input or the total would be too
+large, in which case the total is unchanged. */
+int roman_accumulator_add_numeral(roman_accumulator * accumulator, const char * numeral);
+int roman_accumulator_add_decimal(roman_accumulator * accumulator, const int decimal);
+
+/* Subtract a Roman numeral, or a decimal number (1-3999), from the
+total.  The new total must be greater than or equal to 1.  A '0' value
+is returned if the subtraction succeeds.  A '1' value is returned if
+the subtraction fails, either due to invalid input or the total would
+be too small, in which case the total is unchanged. */
+int roman_accumulator_subtract_numeral(roman_accumulator * accumulator, const char * numeral);
+int roman_accumulator_subtract_decimal(roman_accumulator * accumulator, const int decimal);
+
+/* Set the total back to zero. */
+void roman_accumulator_reset(roman_accumulator * accumulator);
+
+/* Returns the current total as a decimal number, 0-3999.  A NULL
+accumulator has a total of zero. */
+int roman_accumulator_decimal(const roman_accumulator * accumulator);
+
+/* Returns the current total as a null-terminated Roman numeral string.
+The string is owned by the accumulator and remains valid until the
+total next changes or the accumulator is released.  NULL is returned
+if the total is zero or the accumulator is NULL. */
+const char * roman_accumulator_numeral(roman_accumulator * accumulator);
+
+#endif
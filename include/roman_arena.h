@@ -0,0 +1,80 @@
+/*
+roman_arena.h
+
+Header file for the numeral buffer arena of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_ARENA_H
+#define ROMAN_ARENA_H
+
+#include <stddef.h>
+
+/* An arena hands out numeral buffers of ROMAN_NUMERAL_SIZE bytes from
+one block allocated up front, by bumping an offset, so a batch of
+results costs no allocator calls and the whole batch is released at
+once by resetting the arena.  Buffers are plain C strings, large enough
+for any numeral with every engine, so they can be passed as the output
+of convert_decimal_to_roman(), roman_addition(), roman_subtraction(),
+roman_range() and roman_add_columns()/roman_sub_columns(), or used
+through the convenience functions below.  An arena must only be used by
+one thread at a time; multi-threaded callers can use a thread-local
+arena from roman_thread_arena().  The structure is opaque; use the
+functions below. */
+typedef struct roman_arena roman_arena;
+
+/* Number of numeral buffers held by each thread-local arena. */
+#define ROMAN_THREAD_ARENA_CAPACITY 4096
+
+/* Allocates an arena holding "capacity" numeral buffers.  Returns NULL
+if the capacity is 0 or the allocation fails.  Be sure to release the
+arena with free_roman_arena() when done. */
+roman_arena * allocate_roman_arena(const size_t capacity);
+
+/* Releases an arena allocated by allocate_roman_arena(), and with it
+every buffer it handed out.  Passing NULL has no effect. */
+void free_roman_arena(roman_arena * arena);
+
+/* Take the next numeral buffer from the arena.  The buffer holds
+ROMAN_NUMERAL_SIZE bytes, starting with an empty string, and remains
+valid until the arena is reset or released.  NULL is returned if the
+arena is full or NULL. */
+char * roman_arena_numeral(roman_arena * arena);
+
+/* Take "count" consecutive numeral buffers from the arena, buffer i at
+offset i * ROMAN_NUMERAL_SIZE, for the bulk functions.  The buffers are
+not initialised.  NULL is returned if the arena cannot hold "count"
+more buffers, if "count" is 0, or if the arena is NULL. */
+char * roman_arena_numerals(roman_arena * arena, const size_t count);
+
+/* Release every buffer handed out by the arena at once, without
+freeing its memory.  Buffers taken before the reset must no longer be
+used. */
+void roman_arena_reset(roman_arena * arena);
+
+/* Returns the number of buffers handed out since the arena was
+allocated or last reset, and the number it can hold.  A NULL arena
+holds none. */
+size_t roman_arena_used(const roman_arena * arena);
+size_t roman_arena_capacity(const roman_arena * arena);
+
+/* Convert a decimal number, or add or subtract two Roman numerals,
+with the result written to a buffer taken from the arena.  The rules
+are those of convert_decimal_to_roman(), roman_addition() and
+roman_subtraction().  Returns the result string, or NULL if the
+operation fails or the arena is full.  A failed operation does not
+use up a buffer. */
+const char * roman_arena_decimal_to_roman(roman_arena * arena, const int decimal);
+const char * roman_arena_addition(roman_arena * arena, const char * numeral_a, const char * numeral_b);
+const char * roman_arena_subtraction(roman_arena * arena, const char * numeral_a, const char * numeral_b);
+
+/* Returns the calling thread's arena of ROMAN_THREAD_ARENA_CAPACITY
+buffers, allocating it on first use.  The arena is released
+automatically when the thread exits; do not pass it to
+free_roman_arena().  Callers should reset it when they are done with
+a batch of results.  Returns NULL if the allocation fails.  Programs
+using thread-local arenas must link with -lpthread. */
+roman_arena * roman_thread_arena(void);
+
+#endif
@@ -0,0 +1,38 @@
+/*
+roman_columns.h
+
+Header file for the column-wise Roman numeral arithmetic of the Roman
+numeral calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_COLUMNS_H
+#define ROMAN_COLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Add (or subtract) two aligned columns of Roman numerals, row by row:
+row i of the result is column_a[i] + column_b[i] (or column_a[i] -
+column_b[i]).  The rules are those of roman_addition() and
+roman_subtraction(): both operands must be valid Roman numerals, a sum
+must be less than or equal to 3999 and a difference must be greater
+than or equal to 1.  Rather than converting row by row, both columns
+are decoded in blocks, the arithmetic and range checks are done four
+rows at a time, and the results are written with the fixed-size
+numeral writer.
+
+"validity" receives one bit per row, set if the row's result is
+valid: row i is bit (i % 8) of validity[i / 8], and the array must hold
+(count + 7) / 8 bytes.  The outputs are optional (may be NULL):
+"decimal" receives the decimal results and "numeral" the Roman numeral
+results, row i at numeral + i * ROMAN_NUMERAL_SIZE, so it must hold
+count * ROMAN_NUMERAL_SIZE bytes.  Passing NULL for "numeral" skips
+rendering entirely.  Rows with an invalid result get a decimal of 0
+and an empty numeral string.  A '0' value is returned if every row is
+valid.  A '1' value is returned if the input is invalid or any row is
+not valid. */
+int roman_add_columns(const char * const * column_a, const char * const * column_b, const size_t count, uint8_t * validity, int * decimal, char * numeral);
+int roman_sub_columns(const char * const * column_a, const char * const * column_b, const size_t count, uint8_t * validity, int * decimal, char * numeral);
+
+#endif
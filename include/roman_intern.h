@@ -0,0 +1,93 @@
+/*
+roman_intern.h
+
+Header file for the Roman numeral interning table of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_INTERN_H
+#define ROMAN_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* An interning table maps each distinct input string to a compact
+16-bit id, in the order the strings are first seen (0, 1, 2, ...).
+Strings are keyed on their exact bytes, so "iv" and "IV" receive
+different ids.  Each entry caches whether the string is a valid Roman
+numeral, its decimal value and its canonical numeral, so a string that
+repeats many times is only parsed once.  Any number of threads may look
+up ids and read entries while other threads insert: readers take no
+lock, and inserts are serialised internally.  The structure is opaque;
+use the functions below. */
+typedef struct roman_intern roman_intern;
+
+/* Largest number of distinct strings a table can hold. */
+#define ROMAN_INTERN_MAX_ENTRIES 65535
+
+/* Id given by roman_intern_encode() to strings that cannot be interned:
+NULL strings and strings longer than MAX_LENGTH_ROMAN, which are never
+valid Roman numerals, and any string met once the table is full.  It
+is never the id of an entry and always reads as invalid. */
+#define ROMAN_INTERN_INVALID_ID 0xFFFF
+
+/* Allocates an empty table for up to "capacity" distinct strings
+(1-65535).  Returns NULL if the capacity is out of range or the
+allocation fails.  Be sure to release the table with
+free_roman_intern() when done. */
+roman_intern * allocate_roman_intern(const size_t capacity);
+
+/* Releases a table allocated by allocate_roman_intern().  No other
+thread may be using the table.  Passing NULL has no effect. */
+void free_roman_intern(roman_intern * table);
+
+/* Look up the id of a string, adding it to the table if it is new.  A
+'0' value is returned and the id stored in "id" if the string is in
+the table.  A '1' value is returned if the input is invalid, the
+string is longer than MAX_LENGTH_ROMAN, or the table is full. */
+int roman_intern_insert(roman_intern * table, const char * string, uint16_t * id);
+
+/* Look up the id of a string without adding it.  This never blocks.
+A '0' value is returned and the id stored in "id" if the string is in
+the table.  A '1' value is returned otherwise. */
+int roman_intern_find(const roman_intern * table, const char * string, uint16_t * id);
+
+/* Dictionary-encode a column of "count" strings into "ids", adding new
+strings to the table.  The table then serves as the dictionary: the
+entries with ids 0 to roman_intern_count()-1 hold the distinct strings.
+Rows that cannot be interned receive ROMAN_INTERN_INVALID_ID.  A '0'
+value is returned if every row was interned.  A '1' value is returned
+if the input is invalid or any row received ROMAN_INTERN_INVALID_ID. */
+int roman_intern_encode(roman_intern * table, const char * const * column, const size_t count, uint16_t * ids);
+
+/* Returns the number of distinct strings in the table. */
+size_t roman_intern_count(const roman_intern * table);
+
+/* Returns the exact string interned under "id", or NULL if the id is
+not in the table.  The string remains valid until the table is
+released. */
+const char * roman_intern_string(const roman_intern * table, const uint16_t id);
+
+/* Get the decimal value of the entry "id".  A '0' value is returned if
+the entry is a valid Roman numeral.  A '1' value is returned if it is
+not, or the id is not in the table. */
+int roman_intern_decimal(const roman_intern * table, const uint16_t id, int * decimal);
+
+/* Returns the canonical (upper case) Roman numeral of the entry "id",
+or NULL if the entry is not a valid Roman numeral or the id is not in
+the table.  The string remains valid until the table is released. */
+const char * roman_intern_numeral(const roman_intern * table, const uint16_t id);
+
+/* Compare the values of the entries "id_a" and "id_b".  "result"
+receives -1, 0 or 1 as the first value is less than, equal to or
+greater than the second.  A '0' value is returned if both entries are
+valid Roman numerals.  A '1' value is returned otherwise. */
+int roman_intern_compare(const roman_intern * table, const uint16_t id_a, const uint16_t id_b, int * result);
+
+/* Sum the values of "count" entries.  The sum is a plain decimal total
+and is not limited to 3999.  A '0' value is returned if every entry is
+a valid Roman numeral.  A '1' value is returned otherwise. */
+int roman_intern_sum(const roman_intern * table, const uint16_t * ids, const size_t count, long long * sum);
+
+#endif
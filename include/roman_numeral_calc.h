@@ -19,20 +19,58 @@ largest valued Roman numeral string. */
 #define MAX_DECIMAL 3999
 #define MIN_DECIMAL 1
 
+/* Size in bytes of a string that can hold any Roman numeral of value 
+1-3999 and its null-terminating character.  Functions that write many 
+numerals to one array place numeral i at offset i * ROMAN_NUMERAL_SIZE. */
+#define ROMAN_NUMERAL_SIZE sizeof(MAX_LENGTH_ROMAN)
+
+/* Three engines are available for the conversions, selected at 
+compile time.  The default engine builds the numeral symbol by symbol 
+from the decimal place rules.  Defining ROMAN_COMPACT_ENGINE when 
+building the library selects the compact engine instead, which renders 
+each of the four decimal places by copying from small digit tables 
+(under 200 bytes of static data) and does not allocate.  Defining 
+ROMAN_BRANCHLESS_ENGINE selects the branchless engine, whose parse and 
+render run the same instructions for every input, so they do not slow 
+down when the values are unpredictable.  Only the final copy of a 
+numeral into the caller's string depends on its length, which 
+convert_decimal_to_roman_slot() avoids.  All engines produce identical 
+results, and none writes more than a numeral and its null-terminating 
+character to a string, except into the slots of 
+convert_decimal_to_roman_slot().  The library makefile builds the 
+compact and branchless engines as "libromancalc_compact.a" and 
+"libromancalc_branchless.a" and reports the static data size of each 
+engine. */
+
 /* Convert decimal numbers (1-3999) to Roman numerals.  The function 
 writes to a C string provided by the caller.  The array must be large 
 enough to store the characters of the numerals and the null-terminating 
-character.  A '0' value is returned if the conversion was successful.  
-A '1' value is returned if the conversion fails due to invalid input. 
-*/ 
+character, but need not be initialised.  A '0' value is returned if 
+the conversion was successful.  A '1' value is returned if the 
+conversion fails due to invalid input. */
 int convert_decimal_to_roman(const int decimal, char * numeral);
 
+/* Convert a decimal number (1-3999) to Roman numerals in a slot of 
+ROMAN_NUMERAL_SIZE bytes, such as an entry of an array of numerals or 
+an arena buffer.  Every byte of the slot is written: the numeral, then 
+null characters.  With the branchless engine the slot is written with 
+a single store, so unlike convert_decimal_to_roman(), whose copy into 
+the caller's string depends on the numeral's length, the same 
+instructions run for every value.  A '0' value is returned if the 
+conversion was successful.  A '1' value is returned if the conversion 
+fails due to invalid input. */
+int convert_decimal_to_roman_slot(const int decimal, char * numeral);
+
 /* Convert Roman numerals to decimal numbers in the range 1-3999.  The 
 function is passed a C string containing the Roman numerals to convert 
 and a pointer to the integer variable that will receive the converted 
-decimal value.  A '0' value is returned if the conversion was 
-successful.  A '1' value is returned if the conversion fails due to 
-invalid input. */
+decimal value.  Only canonical numerals are accepted, in upper or 
+lower case, so the empty string and strings with trailing symbols 
+(i.e. "XM") are invalid.  The string is never copied and at most 
+strlen(MAX_LENGTH_ROMAN)+1 characters of it are read, so a string 
+longer than MAX_LENGTH_ROMAN is rejected in constant time however long 
+it is.  A '0' value is returned if the conversion was successful.  A 
+'1' value is returned if the conversion fails due to invalid input. */
 int convert_roman_to_decimal(const char * numeral, int * decimal);
 
 /* Add two Roman numerals.  The addition is performed by converting 
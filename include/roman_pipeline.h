@@ -0,0 +1,104 @@
+/*
+roman_pipeline.h
+
+Header file for the pipelined arithmetic engine of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_PIPELINE_H
+#define ROMAN_PIPELINE_H
+
+#include <stddef.h>
+
+#include "roman_numeral_calc.h"
+
+/* A pipeline adds or subtracts a stream of Roman numeral pairs with
+each step on its own thread: one thread parses the operands, one does
+the arithmetic and one renders the results.  Each thread runs the same
+small loop over a whole batch of records at a time, so its code stays
+in the instruction cache, and batches are passed between the threads
+through bounded lock-free single-producer/single-consumer queues of
+fixed-size records.  The rules are those of roman_addition() and
+roman_subtraction(), and results are delivered in submission order.
+
+Records are submitted by one thread (the pipeline's producer) and the
+results are passed to a callback on the render thread.  When a queue
+is full the producer either waits or has its records rejected,
+depending on the pipeline's backpressure setting.  The structure is
+opaque; use the functions below.  Programs using pipelines must link
+with -lpthread. */
+typedef struct roman_pipeline roman_pipeline;
+
+/* Operations of an input record. */
+#define ROMAN_PIPELINE_ADD 0
+#define ROMAN_PIPELINE_SUBTRACT 1
+
+/* Backpressure settings: when the first queue is full, wait for room
+(ROMAN_PIPELINE_BLOCK) or stop accepting records
+(ROMAN_PIPELINE_REJECT). */
+#define ROMAN_PIPELINE_BLOCK 0
+#define ROMAN_PIPELINE_REJECT 1
+
+/* Defaults used for configuration values of 0. */
+#define ROMAN_PIPELINE_DEFAULT_BATCH 256
+#define ROMAN_PIPELINE_DEFAULT_QUEUE 8
+
+/* One operation: numeral_a + numeral_b or numeral_a - numeral_b.
+Numerals longer than MAX_LENGTH_ROMAN do not fit and must be rejected
+before they are submitted. */
+typedef struct {
+	char numeral_a[ROMAN_NUMERAL_SIZE];
+	char numeral_b[ROMAN_NUMERAL_SIZE];
+	int operation;
+} roman_pipeline_input;
+
+/* The result of one operation.  "status" is '0' if the operation
+succeeded and '1' if it failed, either due to invalid input or an out
+of range result, in which case "decimal" is 0 and "numeral" is
+empty. */
+typedef struct {
+	char numeral[ROMAN_NUMERAL_SIZE];
+	int decimal;
+	int status;
+} roman_pipeline_output;
+
+/* Pipeline settings.  "batch_size" is the number of records passed
+between threads at once, and "queue_batches" the number of batches
+each queue holds (rounded up to a power of two), which bounds the
+records in flight.  Zero values select the defaults above. */
+typedef struct {
+	size_t batch_size;
+	size_t queue_batches;
+	int backpressure;
+} roman_pipeline_config;
+
+/* Callback receiving the results of a batch, in submission order, on
+the render thread.  The array is only valid during the call. */
+typedef void (*roman_pipeline_callback)(const roman_pipeline_output * outputs, size_t count, void * context);
+
+/* Start a pipeline and its threads.  "config" may be NULL for the
+default settings.  Returns NULL if the input is invalid or the
+pipeline cannot be started.  Every pipeline must be ended with
+roman_pipeline_finish(). */
+roman_pipeline * roman_pipeline_start(const roman_pipeline_config * config, roman_pipeline_callback callback, void * context);
+
+/* Submit "count" records.  Records are sent to the parse thread a
+batch at a time, as each batch fills.  The number of records taken is
+stored in "accepted" (which may be NULL).  A '0' value is returned if
+every record was taken.  A '1' value is returned if the input is
+invalid or, with ROMAN_PIPELINE_REJECT, the queue filled up, in which
+case the records from "accepted" on were not taken. */
+int roman_pipeline_submit(roman_pipeline * pipeline, const roman_pipeline_input * records, const size_t count, size_t * accepted);
+
+/* Send the records submitted so far without waiting for their batch to
+fill.  Use this to bound the latency of a slow stream of records. */
+void roman_pipeline_flush(roman_pipeline * pipeline);
+
+/* Send any remaining records, wait until every result has been passed
+to the callback, then stop the threads and release the pipeline.  A
+'0' value is returned if the pipeline finished.  A '1' value is
+returned if the pipeline is NULL. */
+int roman_pipeline_finish(roman_pipeline * pipeline);
+
+#endif
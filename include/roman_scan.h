@@ -0,0 +1,54 @@
+/*
+roman_scan.h
+
+Header file for the Roman numeral text scanner of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_SCAN_H
+#define ROMAN_SCAN_H
+
+#include <stddef.h>
+
+/* Flags for the scanner.  By default numerals are matched
+case-insensitively, like convert_roman_to_decimal().  With
+ROMAN_SCAN_UPPERCASE_ONLY only upper case numerals are matched, which
+avoids reporting ordinary words such as "mix" (1009) in prose. */
+#define ROMAN_SCAN_DEFAULT 0
+#define ROMAN_SCAN_UPPERCASE_ONLY 1
+
+/* A Roman numeral found by the scanner: the offset of its first byte
+within the buffer, its length in bytes, and its decimal value. */
+typedef struct {
+	size_t offset;
+	size_t length;
+	int decimal;
+} roman_scan_match;
+
+/* Called by roman_scan() for every numeral found, in buffer order.
+"context" is passed through from the caller unchanged.  Return 0 to
+continue scanning, or any other value to stop. */
+typedef int (*roman_scan_callback)(size_t offset, size_t length, int decimal, void * context);
+
+/* Find every Roman numeral in a buffer of free text.  A numeral is a
+whole word: a run of Roman numeral symbols that is neither preceded
+nor followed by a letter, a digit, or a byte of 0x80 and above (so
+letters of multi-byte encodings such as UTF-8 count as part of a
+word).  Runs that are not valid numerals of 1-3999 are skipped.  The
+buffer need not be null-terminated.  Where SSE2 is available, the
+buffer is classified 64 bytes at a time and regions with no word
+starting with a numeral symbol are skipped without further work.  A
+'0' value is returned if the scan completed or was stopped by the
+callback.  A '1' value is returned if the input is invalid (NULL
+callback, or a NULL buffer with a non-zero length). */
+int roman_scan(const char * buffer, size_t length, int flags, roman_scan_callback callback, void * context);
+
+/* Find Roman numerals as roman_scan() does, storing them in "matches".
+Scanning stops once "capacity" matches have been stored; to continue,
+scan again from the end of the last match.  "count" receives the number
+of matches stored.  A '0' value is returned on success.  A '1' value is
+returned if the input is invalid. */
+int roman_scan_array(const char * buffer, size_t length, int flags, roman_scan_match * matches, size_t capacity, size_t * count);
+
+#endif
@@ -0,0 +1,39 @@
+/*
+roman_sequence.h
+
+Header file for the Roman numeral sequence generator of the Roman
+numeral calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_SEQUENCE_H
+#define ROMAN_SEQUENCE_H
+
+#include <stddef.h>
+
+/* Advance a Roman numeral to its successor (n to n+1) in place.
+"numeral" must hold a canonical, upper case Roman numeral such as
+those written by convert_decimal_to_roman(), in a string of at least
+ROMAN_NUMERAL_SIZE bytes, and "length" must point to its length.  Only
+the low-order decimal places that change are rewritten: usually just
+the ones, and the tens, hundreds and thousands only on a carry.
+"length" is updated and the string stays null-terminated.  The whole
+numeral is validated first, so a numeral that is not canonical or not
+of length "length" is invalid.  A '0' value is returned if the numeral
+was advanced.  A '1' value is returned if
+the input is invalid or the numeral is already 3999 (MMMCMXCIX), in
+which case the numeral is unchanged. */
+int roman_next(char * numeral, size_t * length);
+
+/* Write the Roman numerals for "start", "start"+1, ... to the array
+"out", "count" numerals in total.  Numeral i is written as a
+null-terminated string at out + i * ROMAN_NUMERAL_SIZE, so "out" must
+hold count * ROMAN_NUMERAL_SIZE bytes.  Numerals are produced ten at a
+time from the shared numeral of their thousands, hundreds and tens
+places, so each costs a copy and a table lookup for its ones place.
+A '0' value is returned if the whole sequence was written.  A '1'
+value is returned if the input is invalid or the sequence would leave
+the 1-3999 range, in which case nothing is written. */
+int roman_range(const int start, const int count, char * out);
+
+#endif
@@ -0,0 +1,57 @@
+/*
+roman_stream.h
+
+Header file for the streaming Roman numeral parser of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_STREAM_H
+#define ROMAN_STREAM_H
+
+#include <stddef.h>
+
+/* Called by the streaming parser for every completed token.  "decimal"
+holds the token's value and "status" is '0' if the token is a valid
+Roman numeral.  If the token is not a valid Roman numeral, "status" is
+'1' and "decimal" is 0.  "offset" is the position of the token's first
+byte, counted from the start of the stream.  "context" is passed
+through from the caller unchanged. */
+typedef void (*roman_stream_callback)(int decimal, unsigned long long offset, int status, void * context);
+
+/* State of a streaming parser.  Tokens are runs of bytes between
+delimiters, which are ASCII whitespace, ',' and ';'.  A token may be
+split across any number of chunks: the parser validates each byte as
+it arrives (case-insensitively, like convert_roman_to_decimal()) and
+carries only this small state between calls, so no byte is copied or
+read twice.  The members are managed by the functions below and should
+not be modified by the caller.  The structure may be allocated
+anywhere, but must be initialised with roman_stream_init(). */
+typedef struct {
+	unsigned long long offset;
+	unsigned long long token_offset;
+	int token_value;
+	unsigned int token_state;
+	int token_status;
+	int in_token;
+} roman_stream;
+
+/* Initialise, or reset, a streaming parser to the start of a new
+stream. */
+void roman_stream_init(roman_stream * stream);
+
+/* Parse the next "length" bytes of the stream.  "callback" is called
+for every token that is completed within the chunk, in stream order.
+A token still open at the end of the chunk is continued by the next
+call.  A '0' value is returned if the chunk was parsed.  A '1' value
+is returned if the input is invalid (NULL stream or callback, or a NULL
+chunk with a non-zero length). */
+int roman_stream_feed(roman_stream * stream, const char * chunk, size_t length, roman_stream_callback callback, void * context);
+
+/* Mark the end of the stream.  A token still open is completed and
+reported to "callback", and the parser is reset for a new stream.  A
+'0' value is returned on success.  A '1' value is returned if the
+stream or callback is NULL. */
+int roman_stream_finish(roman_stream * stream, roman_stream_callback callback, void * context);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+roman_table.h
+
+Header file for the precomputed result table of the Roman numeral
+calculator library, libromancalc.
+
+*/
+
+#ifndef ROMAN_TABLE_H
+#define ROMAN_TABLE_H
+
+#include <stdint.h>
+
+/* A result table holds the numeral of every decimal number 0-3999,
+precomputed, so arithmetic through the table only parses its operands
+and looks the result up: nothing is rendered.  The numeral of a sum or
+difference only depends on its value, so one entry per result value
+serves every (a, b, operation) that produces it.  The table can be
+written to a file once with roman_table_write() and mapped read-only by
+any number of processes with roman_table_open(), which shares one copy
+of the pages between them and loads without computing anything, or
+built in memory with roman_table_build().  A table is never modified
+once built, so any number of threads may use it at once.  The structure
+is opaque; use the functions below. */
+typedef struct roman_table roman_table;
+
+/* Layout of a table file, in host byte order: a 64 byte header
+followed by MAX_DECIMAL + 1 entries of ROMAN_NUMERAL_SIZE bytes.
+Entry i holds the numeral of i padded with null characters (entry 0 is
+empty).  The checksum is the 32-bit FNV-1a hash of all the entries. */
+#define ROMAN_TABLE_MAGIC "ROMANTBL"
+#define ROMAN_TABLE_VERSION 1
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t entry_size;
+	uint32_t entry_count;
+	uint32_t checksum;
+	char reserved[40];
+} roman_table_header;
+
+/* Generate a table and write it to the file at "path", replacing any
+existing file.  The table is written to a uniquely named temporary
+file next to it, flushed to disk and renamed into place, so processes
+opening the path never see a partial table, even after a crash, and
+concurrent writers of the same path do not interfere.  A '0' value
+is returned if the file is written.  A '1' value is returned if the
+input is invalid or the file cannot be written. */
+int roman_table_write(const char * path);
+
+/* Map a table file written by roman_table_write().  The header, size
+and checksum are checked before the table is used.  Returns NULL if
+the file cannot be mapped or is not a valid table.  Be sure to release
+the table with roman_table_close() when done. */
+roman_table * roman_table_open(const char * path);
+
+/* Build a table in memory, for processes that do not share one.
+Returns NULL if the allocation fails.  Be sure to release the table
+with roman_table_close() when done. */
+roman_table * roman_table_build(void);
+
+/* Release a table from roman_table_open() or roman_table_build().
+Passing NULL has no effect. */
+void roman_table_close(roman_table * table);
+
+/* Returns the numeral of a decimal number (1-3999) from the table, a
+null-terminated string owned by the table, or NULL if the number is
+out of range or the table is NULL. */
+const char * roman_table_numeral(const roman_table * table, const int decimal);
+
+/* Add or subtract two Roman numerals through the table.  The rules are
+those of roman_addition() and roman_subtraction(), and so is the
+result string, which only needs room for the numeral and its
+null-terminating character: the result is copied from the table rather
+than rendered.  A '0' value is returned if the operation succeeds.  A '1' value is returned if it
+fails, either due to invalid input or an out of range result. */
+int roman_table_addition(const roman_table * table, const char * numeral_a, const char * numeral_b, char * numeral_sum);
+int roman_table_subtraction(const roman_table * table, const char * numeral_a, const char * numeral_b, char * numeral_diff);
+
+#endif
@@ -0,0 +1,202 @@
+/*
+roman_accumulator.c
+
+This file defines the running total accumulator of the Roman numeral calculator library.  The total is kept as a decimal number and rendered to Roman numerals lazily, with the last rendering cached until the total changes.
+
+*/
+
+#include <stdlib.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_accumulator.h"
+#include "roman_probes.h"
+
+/* Accumulator state.  "rendered_decimal" records the total that
+"numeral" currently holds.  It starts at zero, which is never a
+renderable total, so the first request always renders.  */
+struct roman_accumulator {
+	int decimal;
+	int rendered_decimal;
+	char numeral[sizeof(MAX_LENGTH_ROMAN)];
+};
+
+/* Static helper function that applies a decimal change to the total
+if the result stays within the accepted range.  */
+static int apply_change(roman_accumulator * accumulator, const int change);
+
+/* Allocates an accumulator with a total of zero.  See header file for
+full description. */
+roman_accumulator * allocate_roman_accumulator() {
+
+	roman_accumulator * accumulator = (roman_accumulator*)malloc(sizeof(roman_accumulator));
+
+	if(accumulator != NULL) {
+		roman_accumulator_reset(accumulator);
+	}
+
+	return accumulator;
+}
+
+/* Releases an accumulator.  See header file for full description. */
+void free_roman_accumulator(roman_accumulator * accumulator) {
+
+	free(accumulator);
+}
+
+/* Add a Roman numeral to the total.  See header file for full
+description. */
+int roman_accumulator_add_numeral(roman_accumulator * accumulator, const char * numeral) {
+
+	ROMAN_PROBE2(roman_accumulator_add_numeral__entry, accumulator, numeral);
+
+	int decimal;
+
+	if(convert_roman_to_decimal(numeral, &decimal)) {
+
+		//Addition failed, due to conversion failure.
+		ROMAN_PROBE1(roman_accumulator_add_numeral__return, 1);
+		return 1;
+	}
+
+	int failure_flag = roman_accumulator_add_decimal(accumulator, decimal);
+
+	ROMAN_PROBE1(roman_accumulator_add_numeral__return, failure_flag);
+	return failure_flag;
+}
+
+/* Add a decimal number to the total.  See header file for full
+description. */
+int roman_accumulator_add_decimal(roman_accumulator * accumulator, const int decimal) {
+
+	ROMAN_PROBE2(roman_accumulator_add_decimal__entry, accumulator, decimal);
+
+	if(decimal < MIN_DECIMAL || decimal > MAX_DECIMAL) {
+
+		//Addition failed, due to invalid operand.
+		ROMAN_PROBE1(roman_accumulator_add_decimal__return, 1);
+		return 1;
+	}
+
+	int failure_flag = apply_change(accumulator, decimal);
+
+	ROMAN_PROBE1(roman_accumulator_add_decimal__return, failure_flag);
+	return failure_flag;
+}
+
+/* Subtract a Roman numeral from the total.  See header file for full
+description. */
+int roman_accumulator_subtract_numeral(roman_accumulator * accumulator, const char * numeral) {
+
+	ROMAN_PROBE2(roman_accumulator_subtract_numeral__entry, accumulator, numeral);
+
+	int decimal;
+
+	if(convert_roman_to_decimal(numeral, &decimal)) {
+
+		//Subtraction failed, due to conversion failure.
+		ROMAN_PROBE1(roman_accumulator_subtract_numeral__return, 1);
+		return 1;
+	}
+
+	int failure_flag = roman_accumulator_subtract_decimal(accumulator, decimal);
+
+	ROMAN_PROBE1(roman_accumulator_subtract_numeral__return, failure_flag);
+	return failure_flag;
+}
+
+/* Subtract a decimal number from the total.  See header file for full
+description. */
+int roman_accumulator_subtract_decimal(roman_accumulator * accumulator, const int decimal) {
+
+	ROMAN_PROBE2(roman_accumulator_subtract_decimal__entry, accumulator, decimal);
+
+	if(decimal < MIN_DECIMAL || decimal > MAX_DECIMAL) {
+
+		//Subtraction failed, due to invalid operand.
+		ROMAN_PROBE1(roman_accumulator_subtract_decimal__return, 1);
+		return 1;
+	}
+
+	int failure_flag = apply_change(accumulator, -decimal);
+
+	ROMAN_PROBE1(roman_accumulator_subtract_decimal__return, failure_flag);
+	return failure_flag;
+}
+
+/* Set the total back to zero.  See header file for full description. */
+void roman_accumulator_reset(roman_accumulator * accumulator) {
+
+	if(accumulator == NULL) {
+		return;
+	}
+
+	accumulator->decimal = 0;
+	accumulator->rendered_decimal = 0;
+	accumulator->numeral[0] = '\0';
+}
+
+/* Returns the current total as a decimal number.  See header file for
+full description. */
+int roman_accumulator_decimal(const roman_accumulator * accumulator) {
+
+	if(accumulator == NULL) {
+		return 0;
+	}
+
+	return accumulator->decimal;
+}
+
+/* Returns the current total as Roman numerals, rendering only if the
+total has changed since the last call.  See header file for full
+description. */
+const char * roman_accumulator_numeral(roman_accumulator * accumulator) {
+
+	ROMAN_PROBE1(roman_accumulator_numeral__entry, accumulator);
+
+	if(accumulator == NULL || accumulator->decimal < MIN_DECIMAL) {
+
+		//Nothing to render.
+		ROMAN_PROBE1(roman_accumulator_numeral__return, NULL);
+		return NULL;
+	}
+
+	if(accumulator->rendered_decimal != accumulator->decimal) {
+
+		if(convert_decimal_to_roman(accumulator->decimal, accumulator->numeral)) {
+
+			//Rendering failed, the cache is left invalid.
+			ROMAN_PROBE1(roman_accumulator_numeral__return, NULL);
+			return NULL;
+		}
+
+		accumulator->rendered_decimal = accumulator->decimal;
+	}
+
+	ROMAN_PROBE1(roman_accumulator_numeral__return, accumulator->numeral);
+	return accumulator->numeral;
+}
+
+/* Static helper function that applies a decimal change to the total.
+The result must lie within MIN_DECIMAL and MAX_DECIMAL.  The cached
+rendering is not touched; it is simply no longer current once the
+total differs from "rendered_decimal".  */
+static int apply_change(roman_accumulator * accumulator, const int change) {
+
+	if(accumulator == NULL) {
+
+		//Failed, due to invalid input.
+		return 1;
+	}
+
+	int decimal_new = accumulator->decimal + change;
+
+	if(decimal_new < MIN_DECIMAL || decimal_new > MAX_DECIMAL) {
+
+		//Failed, the total would leave the accepted range.
+		return 1;
+	}
+
+	accumulator->decimal = decimal_new;
+
+	return 0;
+}
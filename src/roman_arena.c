@@ -0,0 +1,233 @@
+/*
+roman_arena.c
+
+This file defines the numeral buffer arena of the Roman numeral calculator library.  An arena is one block of fixed-size numeral buffers handed out in order by bumping a count, so taking a buffer, resetting the arena and releasing it are all constant time.  Thread-local arenas are created on first use through a pthread key, whose destructor releases them when their thread exits.
+
+*/
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_arena.h"
+#include "roman_probes.h"
+
+/* Arena state.  "storage" holds "capacity" buffers of
+ROMAN_NUMERAL_SIZE bytes, of which the first "used" are handed out. */
+struct roman_arena {
+	char * storage;
+	size_t capacity;
+	size_t used;
+};
+
+/* Key of the thread-local arenas, created once. */
+static pthread_key_t thread_arena_key;
+static pthread_once_t thread_arena_once = PTHREAD_ONCE_INIT;
+
+/* Static helper function that creates the thread-local arena key. */
+static void create_thread_arena_key(void);
+
+/* Static helper function that releases a thread-local arena when its
+thread exits. */
+static void release_thread_arena(void * arena);
+
+/* Allocates an arena.  See header file for full description. */
+roman_arena * allocate_roman_arena(const size_t capacity) {
+
+	if(capacity < 1 || capacity > (size_t)-1 / ROMAN_NUMERAL_SIZE) {
+
+		//Invalid capacity.
+		return NULL;
+	}
+
+	roman_arena * arena = (roman_arena*)malloc(sizeof(roman_arena));
+	if(arena == NULL) {
+		return NULL;
+	}
+
+	arena->storage = (char*)malloc(capacity * ROMAN_NUMERAL_SIZE);
+	if(arena->storage == NULL) {
+
+		free(arena);
+		return NULL;
+	}
+
+	arena->capacity = capacity;
+	arena->used = 0;
+
+	return arena;
+}
+
+/* Releases an arena.  See header file for full description. */
+void free_roman_arena(roman_arena * arena) {
+
+	if(arena == NULL) {
+		return;
+	}
+
+	free(arena->storage);
+	free(arena);
+}
+
+/* Take the next numeral buffer.  See header file for full
+description. */
+char * roman_arena_numeral(roman_arena * arena) {
+
+	char * numeral = roman_arena_numerals(arena, 1);
+
+	if(numeral != NULL) {
+		numeral[0] = '\0';
+	}
+
+	return numeral;
+}
+
+/* Take consecutive numeral buffers.  See header file for full
+description. */
+char * roman_arena_numerals(roman_arena * arena, const size_t count) {
+
+	if(arena == NULL || count < 1 || count > arena->capacity - arena->used) {
+
+		//Invalid input or arena full.
+		return NULL;
+	}
+
+	char * numerals = arena->storage + arena->used * ROMAN_NUMERAL_SIZE;
+	arena->used += count;
+
+	return numerals;
+}
+
+/* Release every buffer at once.  See header file for full
+description. */
+void roman_arena_reset(roman_arena * arena) {
+
+	if(arena != NULL) {
+		arena->used = 0;
+	}
+}
+
+/* Returns the number of buffers handed out.  See header file for full
+description. */
+size_t roman_arena_used(const roman_arena * arena) {
+
+	return arena != NULL ? arena->used : 0;
+}
+
+/* Returns the number of buffers the arena holds.  See header file for
+full description. */
+size_t roman_arena_capacity(const roman_arena * arena) {
+
+	return arena != NULL ? arena->capacity : 0;
+}
+
+/* Convert a decimal number into an arena buffer.  See header file for
+full description. */
+const char * roman_arena_decimal_to_roman(roman_arena * arena, const int decimal) {
+
+	ROMAN_PROBE2(roman_arena_decimal_to_roman__entry, arena, decimal);
+
+	char * numeral = roman_arena_numeral(arena);
+
+	if(numeral == NULL) {
+		ROMAN_PROBE1(roman_arena_decimal_to_roman__return, NULL);
+		return NULL;
+	}
+
+	//Arena buffers are whole numeral slots.
+	if(convert_decimal_to_roman_slot(decimal, numeral)) {
+
+		//Conversion failed, give the buffer back.  It is the last one
+		//taken, so this only undoes the bump.
+		arena->used--;
+		ROMAN_PROBE1(roman_arena_decimal_to_roman__return, NULL);
+		return NULL;
+	}
+
+	ROMAN_PROBE1(roman_arena_decimal_to_roman__return, numeral);
+	return numeral;
+}
+
+/* Add two Roman numerals into an arena buffer.  See header file for
+full description. */
+const char * roman_arena_addition(roman_arena * arena, const char * numeral_a, const char * numeral_b) {
+
+	ROMAN_PROBE3(roman_arena_addition__entry, arena, numeral_a, numeral_b);
+
+	char * numeral_sum = roman_arena_numeral(arena);
+
+	if(numeral_sum == NULL) {
+		ROMAN_PROBE1(roman_arena_addition__return, NULL);
+		return NULL;
+	}
+
+	if(roman_addition(numeral_a, numeral_b, numeral_sum)) {
+
+		//Addition failed, give the buffer back.
+		arena->used--;
+		ROMAN_PROBE1(roman_arena_addition__return, NULL);
+		return NULL;
+	}
+
+	ROMAN_PROBE1(roman_arena_addition__return, numeral_sum);
+	return numeral_sum;
+}
+
+/* Subtract two Roman numerals into an arena buffer.  See header file
+for full description. */
+const char * roman_arena_subtraction(roman_arena * arena, const char * numeral_a, const char * numeral_b) {
+
+	ROMAN_PROBE3(roman_arena_subtraction__entry, arena, numeral_a, numeral_b);
+
+	char * numeral_diff = roman_arena_numeral(arena);
+
+	if(numeral_diff == NULL) {
+		ROMAN_PROBE1(roman_arena_subtraction__return, NULL);
+		return NULL;
+	}
+
+	if(roman_subtraction(numeral_a, numeral_b, numeral_diff)) {
+
+		//Subtraction failed, give the buffer back.
+		arena->used--;
+		ROMAN_PROBE1(roman_arena_subtraction__return, NULL);
+		return NULL;
+	}
+
+	ROMAN_PROBE1(roman_arena_subtraction__return, numeral_diff);
+	return numeral_diff;
+}
+
+/* Returns the calling thread's arena.  See header file for full
+description. */
+roman_arena * roman_thread_arena(void) {
+
+	pthread_once(&thread_arena_once, create_thread_arena_key);
+
+	roman_arena * arena = (roman_arena*)pthread_getspecific(thread_arena_key);
+
+	if(arena == NULL) {
+
+		arena = allocate_roman_arena(ROMAN_THREAD_ARENA_CAPACITY);
+
+		if(arena != NULL && pthread_setspecific(thread_arena_key, arena)) {
+
+			free_roman_arena(arena);
+			arena = NULL;
+		}
+	}
+
+	return arena;
+}
+
+/* Static helper function that creates the thread-local arena key. */
+static void create_thread_arena_key(void) {
+
+	pthread_key_create(&thread_arena_key, release_thread_arena);
+}
+
+/* Static helper function that releases a thread-local arena. */
+static void release_thread_arena(void * arena) {
+
+	free_roman_arena((roman_arena*)arena);
+}
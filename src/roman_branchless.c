@@ -0,0 +1,12 @@
+/*
+roman_branchless.c
+
+This file defines the symbol tables used by the branch-free conversion kernels in "roman_branchless.h".
+
+*/
+
+#include "roman_branchless.h"
+
+const int roman_code_value[8] = {0, 1000, 500, 100, 50, 10, 5, 1};
+
+const char roman_code_symbol[8] = {'\0', 'M', 'D', 'C', 'L', 'X', 'V', 'I'};
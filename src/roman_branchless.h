@@ -0,0 +1,110 @@
+/*
+roman_branchless.h
+
+Private header for the branch-free conversion kernels of libromancalc,
+used by the branchless engine.  It is not installed with the library.
+
+*/
+
+#ifndef ROMAN_BRANCHLESS_H
+#define ROMAN_BRANCHLESS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_dfa.h"
+#include "roman_render.h"
+
+/* Decimal value and uppercase symbol of each symbol code of
+"roman_byte_class" (1-7 for M, D, C, L, X, V and I), with 0 and '\0'
+for code 0, which is any byte that is not a symbol. */
+extern const int roman_code_value[8];
+extern const char roman_code_symbol[8];
+
+/* Write the Roman numeral for "decimal" (1-3999) to "numeral" with a
+single ROMAN_NUMERAL_SIZE byte store.  The numeral is assembled in a
+zeroed local buffer by the fixed-size writer, one table lookup per
+decimal place, and the length is computed from the digit lengths
+rather than found by branching on the digits, so the code path is the
+same for every value.  "numeral" must have room for ROMAN_NUMERAL_SIZE
+bytes, all of which are written.  Returns the length of the
+numeral. */
+static inline size_t roman_branchless_render(const int decimal, char * numeral) {
+
+	char buffer[ROMAN_NUMERAL_SIZE] = {'\0'};
+	size_t length = roman_render_fixed(decimal, buffer);
+
+	memcpy(numeral, buffer, ROMAN_NUMERAL_SIZE);
+
+	return length;
+}
+
+/* Parse a null-terminated string without data-dependent branches.
+Exactly ROMAN_NUMERAL_SIZE steps are taken: each step reads the
+character at the current position and only advances the position if
+that character is not the null terminator, so nothing past the
+terminator (or past the first ROMAN_NUMERAL_SIZE characters) is ever
+read.  Each symbol is mapped to its value and the values are reduced
+pairwise, subtracting a value when the next one is larger and adding
+it otherwise.  That sum is the value of any canonical numeral, but is
+also a value for many malformed strings ("IIV", "VX"), so the sum is
+rendered back with the fixed-size writer and compared with the
+uppercased input, 16 bytes at once: the string is a numeral only if it
+is the canonical form of its own value.  Returns the decimal value of a
+valid numeral, or 0 if the string is not one. */
+static inline int roman_branchless_parse(const char * numeral) {
+
+	char symbols[ROMAN_NUMERAL_SIZE];
+	int values[ROMAN_NUMERAL_SIZE + 1];
+	size_t position = 0;
+	unsigned int invalid = 0;
+
+	for(size_t i=0; i<ROMAN_NUMERAL_SIZE; i++) {
+
+		unsigned char c = (unsigned char)numeral[position];
+		unsigned int code = roman_byte_class[c] & ROMAN_CLASS_SYMBOL_MASK;
+		unsigned int present = c != '\0';
+
+		//A character that is present but not a symbol is invalid.
+		invalid |= present & (code == 0);
+		symbols[i] = roman_code_symbol[code];
+		values[i] = roman_code_value[code];
+		position += present;
+	}
+
+	values[ROMAN_NUMERAL_SIZE] = 0;
+
+	//A string that fills every step has no room for its terminator,
+	//so it is longer than MAX_LENGTH_ROMAN.
+	invalid |= position == ROMAN_NUMERAL_SIZE;
+
+	int sum = 0;
+
+	for(size_t i=0; i<ROMAN_NUMERAL_SIZE; i++) {
+
+		//All ones if the next value is larger, negating this one.
+		int negate = -(values[i] < values[i+1]);
+		sum += (values[i] ^ negate) - negate;
+	}
+
+	//Sums outside 1-3999 are rendered as the empty string, which
+	//cannot match a valid input.
+	unsigned int in_range = (unsigned int)(sum - MIN_DECIMAL) <= (unsigned int)(MAX_DECIMAL - MIN_DECIMAL);
+	sum &= -(int)in_range;
+
+	char canonical[ROMAN_NUMERAL_SIZE] = {'\0'};
+	roman_render_fixed(sum, canonical);
+
+	uint64_t input_words[2];
+	uint64_t canonical_words[2];
+	memcpy(input_words, symbols, sizeof(input_words));
+	memcpy(canonical_words, canonical, sizeof(canonical_words));
+
+	uint64_t difference = (input_words[0] ^ canonical_words[0]) | (input_words[1] ^ canonical_words[1]);
+	unsigned int valid = (invalid == 0) & in_range & (difference == 0);
+
+	return sum & -(int)valid;
+}
+
+#endif
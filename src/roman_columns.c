@@ -0,0 +1,173 @@
+/*
+roman_columns.c
+
+This file defines the column-wise Roman numeral arithmetic.  Columns are processed in blocks of BLOCK_ROWS rows: both operand columns are decoded into decimal arrays, the arithmetic and range checks are done four rows at a time (with SSE2 where the compiler targets it), and the results are rendered with the fixed-size numeral writer.
+
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "roman_numeral_calc.h"
+#include "roman_columns.h"
+#include "roman_dfa.h"
+#include "roman_render.h"
+#include "roman_probes.h"
+
+//Rows per block.  A multiple of 8, so each block fills whole bytes of
+//the validity bitmask.
+#define BLOCK_ROWS 256
+
+/* Static helper function that performs the operation on two columns. */
+static int combine_columns(const char * const * column_a, const char * const * column_b, const size_t count, const int subtract, uint8_t * validity, int * decimal, char * numeral);
+
+/* Static helper function that combines four rows, storing the results
+and returning a 4 bit mask of the valid rows. */
+static inline unsigned int combine_four(const int * values_a, const int * values_b, const int subtract, int * results);
+
+/* Add two columns of Roman numerals.  See header file for full
+description. */
+int roman_add_columns(const char * const * column_a, const char * const * column_b, const size_t count, uint8_t * validity, int * decimal, char * numeral) {
+
+	ROMAN_PROBE3(roman_add_columns__entry, column_a, column_b, count);
+
+	int failure_flag = combine_columns(column_a, column_b, count, 0, validity, decimal, numeral);
+
+	ROMAN_PROBE1(roman_add_columns__return, failure_flag);
+	return failure_flag;
+}
+
+/* Subtract two columns of Roman numerals.  See header file for full
+description. */
+int roman_sub_columns(const char * const * column_a, const char * const * column_b, const size_t count, uint8_t * validity, int * decimal, char * numeral) {
+
+	ROMAN_PROBE3(roman_sub_columns__entry, column_a, column_b, count);
+
+	int failure_flag = combine_columns(column_a, column_b, count, 1, validity, decimal, numeral);
+
+	ROMAN_PROBE1(roman_sub_columns__return, failure_flag);
+	return failure_flag;
+}
+
+/* Static helper function that performs the operation on two columns,
+one block at a time. */
+static int combine_columns(const char * const * column_a, const char * const * column_b, const size_t count, const int subtract, uint8_t * validity, int * decimal, char * numeral) {
+
+	if(count > 0 && (column_a == NULL || column_b == NULL || validity == NULL)) {
+
+		//Invalid input.
+		return 1;
+	}
+
+	//Decoded operands and results of one block.  Invalid operands
+	//decode to 0, which no valid numeral has.
+	int values_a[BLOCK_ROWS];
+	int values_b[BLOCK_ROWS];
+	int results[BLOCK_ROWS];
+
+	size_t valid_rows = 0;
+
+	for(size_t base=0; base<count; base+=BLOCK_ROWS) {
+
+		size_t rows = count - base < BLOCK_ROWS ? count - base : BLOCK_ROWS;
+
+		//Decode both columns.  NULL strings are invalid operands.
+		for(size_t i=0; i<rows; i++) {
+			values_a[i] = column_a[base+i] != NULL ? roman_dfa_parse(column_a[base+i]) : 0;
+			values_b[i] = column_b[base+i] != NULL ? roman_dfa_parse(column_b[base+i]) : 0;
+		}
+
+		//Pad to a multiple of four rows with invalid operands.
+		size_t padded_rows = (rows + 3) & ~(size_t)3;
+		for(size_t i=rows; i<padded_rows; i++) {
+			values_a[i] = 0;
+			values_b[i] = 0;
+		}
+
+		//Combine four rows at a time, building the validity bitmask.
+		uint8_t * block_validity = validity + base / 8;
+		memset(block_validity, 0, (rows + 7) / 8);
+
+		for(size_t i=0; i<padded_rows; i+=4) {
+
+			unsigned int mask = combine_four(values_a + i, values_b + i, subtract, results + i);
+
+			//Drop the padding rows.
+			if(rows - i < 4) {
+				mask &= (1u << (rows - i)) - 1;
+			}
+
+			block_validity[i / 8] |= (uint8_t)(mask << (i % 8));
+			valid_rows += (size_t)__builtin_popcount(mask);
+		}
+
+		if(decimal != NULL) {
+			memcpy(decimal + base, results, rows * sizeof(int));
+		}
+
+		if(numeral != NULL) {
+			for(size_t i=0; i<rows; i++) {
+				roman_render_fixed(results[i], numeral + (base + i) * ROMAN_NUMERAL_SIZE);
+			}
+		}
+	}
+
+	return valid_rows != count;
+}
+
+#ifdef __SSE2__
+
+/* Static helper function that combines four rows with SSE2.  The range
+check of a sum (MAX_DECIMAL not less than the sum) and a difference
+(the difference greater than MIN_DECIMAL - 1) are both signed
+comparisons, and an operand is valid if it is greater than 0. */
+static inline unsigned int combine_four(const int * values_a, const int * values_b, const int subtract, int * results) {
+
+	__m128i a = _mm_loadu_si128((const __m128i *)values_a);
+	__m128i b = _mm_loadu_si128((const __m128i *)values_b);
+	__m128i zero = _mm_setzero_si128();
+	__m128i result;
+	__m128i in_range;
+
+	if(subtract) {
+		result = _mm_sub_epi32(a, b);
+		in_range = _mm_cmpgt_epi32(result, _mm_set1_epi32(MIN_DECIMAL - 1));
+	}
+	else {
+		result = _mm_add_epi32(a, b);
+		in_range = _mm_cmpgt_epi32(_mm_set1_epi32(MAX_DECIMAL + 1), result);
+	}
+
+	__m128i valid = _mm_and_si128(in_range, _mm_and_si128(_mm_cmpgt_epi32(a, zero), _mm_cmpgt_epi32(b, zero)));
+
+	//Invalid rows get a result of 0.
+	_mm_storeu_si128((__m128i *)results, _mm_and_si128(result, valid));
+
+	return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(valid));
+}
+
+#else
+
+/* Static helper function that combines four rows, one at a time. */
+static inline unsigned int combine_four(const int * values_a, const int * values_b, const int subtract, int * results) {
+
+	unsigned int mask = 0;
+
+	for(int i=0; i<4; i++) {
+
+		int result = subtract ? values_a[i] - values_b[i] : values_a[i] + values_b[i];
+		int valid = values_a[i] > 0 && values_b[i] > 0 && result >= MIN_DECIMAL && result <= MAX_DECIMAL;
+
+		results[i] = valid ? result : 0;
+		mask |= (unsigned int)valid << i;
+	}
+
+	return mask;
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*
+roman_dfa.c
+
+This file defines the lookup tables used by the incremental Roman numeral validator in "roman_dfa.h".
+
+*/
+
+#include "roman_dfa.h"
+
+//Shorthand for the table below: a word character that is also a
+//Roman numeral symbol with the given symbol code.
+#define SYMBOL(code) (ROMAN_CLASS_WORD | (code))
+
+//Shorthand for the table below: the 16 word characters from "base".
+#define WORD_ROW(base) \
+	[(base) + 0x0] = ROMAN_CLASS_WORD, [(base) + 0x1] = ROMAN_CLASS_WORD, \
+	[(base) + 0x2] = ROMAN_CLASS_WORD, [(base) + 0x3] = ROMAN_CLASS_WORD, \
+	[(base) + 0x4] = ROMAN_CLASS_WORD, [(base) + 0x5] = ROMAN_CLASS_WORD, \
+	[(base) + 0x6] = ROMAN_CLASS_WORD, [(base) + 0x7] = ROMAN_CLASS_WORD, \
+	[(base) + 0x8] = ROMAN_CLASS_WORD, [(base) + 0x9] = ROMAN_CLASS_WORD, \
+	[(base) + 0xA] = ROMAN_CLASS_WORD, [(base) + 0xB] = ROMAN_CLASS_WORD, \
+	[(base) + 0xC] = ROMAN_CLASS_WORD, [(base) + 0xD] = ROMAN_CLASS_WORD, \
+	[(base) + 0xE] = ROMAN_CLASS_WORD, [(base) + 0xF] = ROMAN_CLASS_WORD
+
+/* Class of every byte value.  Letters and digits are word characters,
+as are all bytes of 0x80 and above so that letters of multi-byte
+encodings such as UTF-8 are never treated as word boundaries.  ASCII
+whitespace, ',' and ';' delimit tokens for the streaming parser. */
+const unsigned char roman_byte_class[256] = {
+	['\t'] = ROMAN_CLASS_DELIMITER, ['\n'] = ROMAN_CLASS_DELIMITER,
+	['\v'] = ROMAN_CLASS_DELIMITER, ['\f'] = ROMAN_CLASS_DELIMITER,
+	['\r'] = ROMAN_CLASS_DELIMITER, [' '] = ROMAN_CLASS_DELIMITER,
+	[','] = ROMAN_CLASS_DELIMITER, [';'] = ROMAN_CLASS_DELIMITER,
+
+	['0'] = ROMAN_CLASS_WORD, ['1'] = ROMAN_CLASS_WORD, ['2'] = ROMAN_CLASS_WORD,
+	['3'] = ROMAN_CLASS_WORD, ['4'] = ROMAN_CLASS_WORD, ['5'] = ROMAN_CLASS_WORD,
+	['6'] = ROMAN_CLASS_WORD, ['7'] = ROMAN_CLASS_WORD, ['8'] = ROMAN_CLASS_WORD,
+	['9'] = ROMAN_CLASS_WORD,
+
+	['A'] = ROMAN_CLASS_WORD, ['B'] = ROMAN_CLASS_WORD, ['C'] = SYMBOL(3),
+	['D'] = SYMBOL(2), ['E'] = ROMAN_CLASS_WORD, ['F'] = ROMAN_CLASS_WORD,
+	['G'] = ROMAN_CLASS_WORD, ['H'] = ROMAN_CLASS_WORD, ['I'] = SYMBOL(7),
+	['J'] = ROMAN_CLASS_WORD, ['K'] = ROMAN_CLASS_WORD, ['L'] = SYMBOL(4),
+	['M'] = SYMBOL(1), ['N'] = ROMAN_CLASS_WORD, ['O'] = ROMAN_CLASS_WORD,
+	['P'] = ROMAN_CLASS_WORD, ['Q'] = ROMAN_CLASS_WORD, ['R'] = ROMAN_CLASS_WORD,
+	['S'] = ROMAN_CLASS_WORD, ['T'] = ROMAN_CLASS_WORD, ['U'] = ROMAN_CLASS_WORD,
+	['V'] = SYMBOL(6), ['W'] = ROMAN_CLASS_WORD, ['X'] = SYMBOL(5),
+	['Y'] = ROMAN_CLASS_WORD, ['Z'] = ROMAN_CLASS_WORD,
+
+	['a'] = ROMAN_CLASS_WORD, ['b'] = ROMAN_CLASS_WORD, ['c'] = SYMBOL(3),
+	['d'] = SYMBOL(2), ['e'] = ROMAN_CLASS_WORD, ['f'] = ROMAN_CLASS_WORD,
+	['g'] = ROMAN_CLASS_WORD, ['h'] = ROMAN_CLASS_WORD, ['i'] = SYMBOL(7),
+	['j'] = ROMAN_CLASS_WORD, ['k'] = ROMAN_CLASS_WORD, ['l'] = SYMBOL(4),
+	['m'] = SYMBOL(1), ['n'] = ROMAN_CLASS_WORD, ['o'] = ROMAN_CLASS_WORD,
+	['p'] = ROMAN_CLASS_WORD, ['q'] = ROMAN_CLASS_WORD, ['r'] = ROMAN_CLASS_WORD,
+	['s'] = ROMAN_CLASS_WORD, ['t'] = ROMAN_CLASS_WORD, ['u'] = ROMAN_CLASS_WORD,
+	['v'] = SYMBOL(6), ['w'] = ROMAN_CLASS_WORD, ['x'] = SYMBOL(5),
+	['y'] = ROMAN_CLASS_WORD, ['z'] = ROMAN_CLASS_WORD,
+
+	WORD_ROW(0x80), WORD_ROW(0x90), WORD_ROW(0xA0), WORD_ROW(0xB0),
+	WORD_ROW(0xC0), WORD_ROW(0xD0), WORD_ROW(0xE0), WORD_ROW(0xF0)
+};
+
+const int roman_place_unit[4] = {1000, 100, 10, 1};
@@ -0,0 +1,182 @@
+/*
+roman_dfa.h
+
+Private header for the incremental Roman numeral validator used by the
+converter, streaming and scanning parsers of libromancalc.  It is not installed
+with the library.
+
+*/
+
+#ifndef ROMAN_DFA_H
+#define ROMAN_DFA_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "roman_numeral_calc.h"
+
+/* Byte classes.  The low three bits hold the symbol code of a Roman
+numeral symbol, in either case: 1-7 for M, D, C, L, X, V and I (the
+order of "roman_symbol" in roman_numeral_calc.c), or 0 for any other
+byte.  The remaining bits flag token delimiters for the streaming
+parser and word characters for the scanner.  */
+#define ROMAN_CLASS_SYMBOL_MASK 0x07
+#define ROMAN_CLASS_DELIMITER 0x08
+#define ROMAN_CLASS_WORD 0x10
+
+extern const unsigned char roman_byte_class[256];
+
+/* Decimal value of one unit in each decimal place, from the thousands
+down to the ones. */
+extern const int roman_place_unit[4];
+
+/* Symbol code of a byte and decimal value of one unit in a decimal
+place, as found in the tables above.  The compact engine computes them
+instead, so its converter does not need the tables in roman_dfa.o
+(288 bytes, more than the compact engine's own data). */
+#if defined(ROMAN_COMPACT_ENGINE)
+
+static inline int roman_symbol_code(const unsigned char byte) {
+
+	//Setting bit 5 folds upper case into lower case.  The lower case 
+	//symbols are 0x60-0x7F bytes, whose low five bits index 3-bit codes 
+	//packed into two constants (0x60-0x6F and 0x70-0x7F), so the code 
+	//is found with a shift rather than a table or a chain of compares.
+	const unsigned int lower = byte | 0x20;
+	const uint64_t codes = (lower & 0x10) ? 0x5180000ULL : 0xC038002600ULL;
+
+	return ((lower & 0xE0) == 0x60) * (int)((codes >> (3 * (lower & 0x0F))) & 7);
+}
+
+static inline int roman_unit(const unsigned int place) {
+
+	//1000, 100, 10 and 1 packed 10 bits apiece.
+	return (int)((0x40A193E8ULL >> (10 * place)) & 0x3FF);
+}
+
+#else
+
+static inline int roman_symbol_code(const unsigned char byte) {
+
+	return roman_byte_class[byte] & ROMAN_CLASS_SYMBOL_MASK;
+}
+
+static inline int roman_unit(const unsigned int place) {
+
+	return roman_place_unit[place];
+}
+
+#endif
+
+/* Initial state of the validator, before any symbol has been read. */
+#define ROMAN_DFA_START 0u
+
+/* Advance the validator by one symbol ("symbol" is the symbol code
+minus 1, so 0 for M through 6 for I) and add the symbol's contribution
+to "value".  Only canonical numerals of 1-3999 are accepted: per
+decimal place, up to three "one" symbols, or a leading "five" symbol
+followed by up to three "one" symbols, or the subtractive pairs for 4
+and 9, with the decimal places in descending order.  Symbols are never
+revisited, so a numeral is validated in a single pass.
+
+The state packs the current decimal place (0 for the thousands to 3
+for the ones) in bits 3 and up, a flag for a "five" symbol in bit 2
+and the count of "one" symbols in bits 0-1.  A place that holds a
+subtractive pair is marked as full (five flag set, three ones), as
+nothing may follow it within the place.  A '0' value is returned if
+the symbol is accepted.  A '1' value is returned if the numeral can no
+longer be valid, in which case the state and value must be discarded.
+A numeral is complete and valid whenever at least one symbol has been
+accepted. */
+static inline int roman_dfa_step(unsigned int * state, int * value, int symbol) {
+
+	unsigned int place = *state >> 3;
+	unsigned int five = (*state >> 2) & 1;
+	unsigned int ones = *state & 3;
+
+	//If the symbol does not continue the current decimal place, the
+	//place is finished and the symbol must start a lower one.
+	for(; place < 4; place++, five = 0, ones = 0) {
+
+		//Symbol codes of the numerals for 1, 5 and 10 in this place.
+		//The thousands place only has a numeral for 1.
+		int symbol_one = 2 * place;
+		int unit = roman_unit(place);
+
+		if(symbol == symbol_one && ones < 3) {
+
+			*value += unit;
+			ones++;
+			break;
+		}
+
+		if(place > 0 && !five) {
+
+			if(symbol == symbol_one - 1 && ones == 0) {
+
+				//Leading five (i.e. V).
+				*value += 5 * unit;
+				five = 1;
+				break;
+			}
+
+			if(symbol == symbol_one - 1 && ones == 1) {
+
+				//Subtractive four (i.e. IV).  The 1 was already added.
+				*value += 3 * unit;
+				five = 1;
+				ones = 3;
+				break;
+			}
+
+			if(symbol == symbol_one - 2 && ones == 1) {
+
+				//Subtractive nine (i.e. IX).  The 1 was already added.
+				*value += 8 * unit;
+				five = 1;
+				ones = 3;
+				break;
+			}
+		}
+	}
+
+	if(place >= 4) {
+
+		//No remaining decimal place accepts the symbol.
+		return 1;
+	}
+
+	*state = (place << 3) | (five << 2) | ones;
+
+	return 0;
+}
+
+/* Parse a null-terminated string with the validator.  At most 
+MAX_LENGTH_ROMAN plus one characters are read: a longer string is not 
+a valid numeral, and is rejected without reading the rest of it.  
+Returns the decimal value of a valid numeral, or 0 if the string is 
+not one. */
+static inline int roman_dfa_parse(const char * numeral) {
+
+	unsigned int state = ROMAN_DFA_START;
+	int value = 0;
+
+	//MAX_LENGTH_ROMAN is the longest numeral, so its terminator is the
+	//last character that needs to be read.
+	for(size_t i=0; i<=strlen(MAX_LENGTH_ROMAN); i++) {
+
+		int code = roman_symbol_code((unsigned char)numeral[i]);
+
+		if(numeral[i] == '\0') {
+			return value;
+		}
+
+		if(code == 0 || roman_dfa_step(&state, &value, code - 1)) {
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+#endif
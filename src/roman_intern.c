@@ -0,0 +1,406 @@
+/*
+roman_intern.c
+
+This file defines the Roman numeral interning table.  Entries are stored in an array indexed by id, and found through an open addressing hash table of ids.  An entry is written completely before its id is published to the hash table (with release ordering), so readers that find the id (with acquire ordering) always see the whole entry and need no lock.  Inserts are serialised by a mutex.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_intern.h"
+#include "roman_probes.h"
+
+/* A distinct string, its exact bytes and the cached results of parsing
+it.  "numeral" is empty if the string is not a valid Roman numeral. */
+typedef struct {
+	char key[ROMAN_NUMERAL_SIZE];
+	char numeral[ROMAN_NUMERAL_SIZE];
+	int decimal;
+	int valid;
+} intern_entry;
+
+/* The table.  "slots" holds id+1 of the entry hashed there, or 0 for
+an empty slot, and has at least twice as many slots as the table has
+entries so probe sequences stay short. */
+struct roman_intern {
+	intern_entry * entries;
+	uint16_t * slots;
+	size_t slot_mask;
+	size_t capacity;
+	size_t count;
+	pthread_mutex_t insert_lock;
+};
+
+/* Static helper function that measures a string, up to MAX_LENGTH_ROMAN
+plus one characters, and hashes it.  Returns the length, which is
+greater than strlen(MAX_LENGTH_ROMAN) if the string is too long. */
+static size_t measure_key(const char * string, uint32_t * hash);
+
+/* Static helper function that probes for a string.  Returns the slot
+holding it, or the empty slot that ends its probe sequence. */
+static size_t probe(const roman_intern * table, const char * string, size_t length, uint32_t hash, uint16_t * slot_value);
+
+/* Static helper function that returns the entry for an id, or NULL if
+the id is not in the table. */
+static const intern_entry * find_entry(const roman_intern * table, const uint16_t id);
+
+/* Allocates an empty table.  See header file for full description. */
+roman_intern * allocate_roman_intern(const size_t capacity) {
+
+	if(capacity < 1 || capacity > ROMAN_INTERN_MAX_ENTRIES) {
+
+		//Invalid capacity.
+		return NULL;
+	}
+
+	size_t slot_count = 1;
+	while(slot_count < 2 * capacity) {
+		slot_count <<= 1;
+	}
+
+	roman_intern * table = (roman_intern*)malloc(sizeof(roman_intern));
+	if(table == NULL) {
+		return NULL;
+	}
+
+	table->entries = (intern_entry*)malloc(sizeof(intern_entry) * capacity);
+	table->slots = (uint16_t*)calloc(slot_count, sizeof(uint16_t));
+
+	if(table->entries == NULL || table->slots == NULL) {
+
+		free(table->entries);
+		free(table->slots);
+		free(table);
+		return NULL;
+	}
+
+	table->slot_mask = slot_count - 1;
+	table->capacity = capacity;
+	table->count = 0;
+	pthread_mutex_init(&table->insert_lock, NULL);
+
+	return table;
+}
+
+/* Releases a table.  See header file for full description. */
+void free_roman_intern(roman_intern * table) {
+
+	if(table == NULL) {
+		return;
+	}
+
+	pthread_mutex_destroy(&table->insert_lock);
+	free(table->entries);
+	free(table->slots);
+	free(table);
+}
+
+/* Look up the id of a string, adding it if new.  See header file for
+full description. */
+int roman_intern_insert(roman_intern * table, const char * string, uint16_t * id) {
+
+	ROMAN_PROBE2(roman_intern_insert__entry, table, string);
+
+	if(table == NULL || string == NULL || id == NULL) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_intern_insert__return, 1);
+		return 1;
+	}
+
+	uint32_t hash;
+	size_t length = measure_key(string, &hash);
+
+	if(length > strlen(MAX_LENGTH_ROMAN)) {
+
+		//Too long to be a Roman numeral, not interned.
+		ROMAN_PROBE1(roman_intern_insert__return, 1);
+		return 1;
+	}
+
+	uint16_t slot_value;
+	size_t slot = probe(table, string, length, hash, &slot_value);
+
+	//Most lookups find an existing entry without taking the lock.
+	if(slot_value != 0) {
+
+		*id = (uint16_t)(slot_value - 1);
+		ROMAN_PROBE1(roman_intern_insert__return, 0);
+		return 0;
+	}
+
+	pthread_mutex_lock(&table->insert_lock);
+
+	//Another thread may have inserted the string since the probe.
+	slot = probe(table, string, length, hash, &slot_value);
+
+	if(slot_value != 0) {
+
+		pthread_mutex_unlock(&table->insert_lock);
+		*id = (uint16_t)(slot_value - 1);
+		ROMAN_PROBE1(roman_intern_insert__return, 0);
+		return 0;
+	}
+
+	size_t count = table->count;
+
+	if(count >= table->capacity) {
+
+		//Table full.
+		pthread_mutex_unlock(&table->insert_lock);
+		ROMAN_PROBE1(roman_intern_insert__return, 1);
+		return 1;
+	}
+
+	//Fill in the new entry before publishing it.
+	intern_entry * entry = &table->entries[count];
+
+	memset(entry, 0, sizeof(intern_entry));
+	memcpy(entry->key, string, length);
+
+	entry->valid = convert_roman_to_decimal(entry->key, &entry->decimal) == 0;
+
+	if(entry->valid && convert_decimal_to_roman(entry->decimal, entry->numeral)) {
+		entry->valid = 0;
+	}
+
+	if(!entry->valid) {
+		entry->decimal = 0;
+	}
+
+	__atomic_store_n(&table->slots[slot], (uint16_t)(count + 1), __ATOMIC_RELEASE);
+	__atomic_store_n(&table->count, count + 1, __ATOMIC_RELEASE);
+
+	pthread_mutex_unlock(&table->insert_lock);
+
+	*id = (uint16_t)count;
+	ROMAN_PROBE1(roman_intern_insert__return, 0);
+	return 0;
+}
+
+/* Look up the id of a string without adding it.  See header file for
+full description. */
+int roman_intern_find(const roman_intern * table, const char * string, uint16_t * id) {
+
+	ROMAN_PROBE2(roman_intern_find__entry, table, string);
+
+	if(table == NULL || string == NULL || id == NULL) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_intern_find__return, 1);
+		return 1;
+	}
+
+	uint32_t hash;
+	size_t length = measure_key(string, &hash);
+
+	if(length > strlen(MAX_LENGTH_ROMAN)) {
+
+		//Too long to have been interned.
+		ROMAN_PROBE1(roman_intern_find__return, 1);
+		return 1;
+	}
+
+	uint16_t slot_value;
+	probe(table, string, length, hash, &slot_value);
+
+	if(slot_value == 0) {
+
+		//Not in the table.
+		ROMAN_PROBE1(roman_intern_find__return, 1);
+		return 1;
+	}
+
+	*id = (uint16_t)(slot_value - 1);
+	ROMAN_PROBE1(roman_intern_find__return, 0);
+	return 0;
+}
+
+/* Dictionary-encode a column of strings.  See header file for full
+description. */
+int roman_intern_encode(roman_intern * table, const char * const * column, const size_t count, uint16_t * ids) {
+
+	ROMAN_PROBE3(roman_intern_encode__entry, table, column, count);
+
+	if(table == NULL || ((column == NULL || ids == NULL) && count > 0)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_intern_encode__return, 1);
+		return 1;
+	}
+
+	int failure_flag = 0;
+
+	for(size_t i=0; i<count; i++) {
+
+		if(roman_intern_insert(table, column[i], &ids[i])) {
+
+			ids[i] = ROMAN_INTERN_INVALID_ID;
+			failure_flag = 1;
+		}
+	}
+
+	ROMAN_PROBE1(roman_intern_encode__return, failure_flag);
+	return failure_flag;
+}
+
+/* Returns the number of distinct strings.  See header file for full
+description. */
+size_t roman_intern_count(const roman_intern * table) {
+
+	if(table == NULL) {
+		return 0;
+	}
+
+	return __atomic_load_n(&table->count, __ATOMIC_ACQUIRE);
+}
+
+/* Returns the exact string of an entry.  See header file for full
+description. */
+const char * roman_intern_string(const roman_intern * table, const uint16_t id) {
+
+	const intern_entry * entry = find_entry(table, id);
+
+	return entry != NULL ? entry->key : NULL;
+}
+
+/* Get the decimal value of an entry.  See header file for full
+description. */
+int roman_intern_decimal(const roman_intern * table, const uint16_t id, int * decimal) {
+
+	const intern_entry * entry = find_entry(table, id);
+
+	if(entry == NULL || !entry->valid || decimal == NULL) {
+
+		//Unknown id or not a Roman numeral.
+		return 1;
+	}
+
+	*decimal = entry->decimal;
+	return 0;
+}
+
+/* Returns the canonical numeral of an entry.  See header file for full
+description. */
+const char * roman_intern_numeral(const roman_intern * table, const uint16_t id) {
+
+	const intern_entry * entry = find_entry(table, id);
+
+	return (entry != NULL && entry->valid) ? entry->numeral : NULL;
+}
+
+/* Compare the values of two entries.  See header file for full
+description. */
+int roman_intern_compare(const roman_intern * table, const uint16_t id_a, const uint16_t id_b, int * result) {
+
+	ROMAN_PROBE3(roman_intern_compare__entry, table, id_a, id_b);
+
+	int decimal_a;
+	int decimal_b;
+
+	if(result == NULL || roman_intern_decimal(table, id_a, &decimal_a) || roman_intern_decimal(table, id_b, &decimal_b)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_intern_compare__return, 1);
+		return 1;
+	}
+
+	*result = (decimal_a > decimal_b) - (decimal_a < decimal_b);
+	ROMAN_PROBE1(roman_intern_compare__return, 0);
+	return 0;
+}
+
+/* Sum the values of many entries.  See header file for full
+description. */
+int roman_intern_sum(const roman_intern * table, const uint16_t * ids, const size_t count, long long * sum) {
+
+	ROMAN_PROBE3(roman_intern_sum__entry, table, ids, count);
+
+	if(table == NULL || sum == NULL || (ids == NULL && count > 0)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_intern_sum__return, 1);
+		return 1;
+	}
+
+	//Entries below "known" were complete when the count was read, so
+	//they can be read directly.
+	size_t known = roman_intern_count(table);
+	long long total = 0;
+
+	for(size_t i=0; i<count; i++) {
+
+		if(ids[i] >= known || !table->entries[ids[i]].valid) {
+
+			//Unknown id or not a Roman numeral.
+			ROMAN_PROBE1(roman_intern_sum__return, 1);
+			return 1;
+		}
+
+		total += table->entries[ids[i]].decimal;
+	}
+
+	*sum = total;
+	ROMAN_PROBE1(roman_intern_sum__return, 0);
+	return 0;
+}
+
+/* Static helper function that measures and hashes a string (FNV-1a). */
+static size_t measure_key(const char * string, uint32_t * hash) {
+
+	uint32_t value = 2166136261u;
+	size_t length = 0;
+
+	while(length <= strlen(MAX_LENGTH_ROMAN) && string[length] != '\0') {
+
+		value = (value ^ (unsigned char)string[length]) * 16777619u;
+		length++;
+	}
+
+	*hash = value;
+	return length;
+}
+
+/* Static helper function that probes for a string, linearly from its
+hash.  The slot value read is stored in "slot_value": id+1 if the
+string was found, or 0 at the empty slot ending the probe sequence.
+The table never fills its slots, so the probe always ends. */
+static size_t probe(const roman_intern * table, const char * string, size_t length, uint32_t hash, uint16_t * slot_value) {
+
+	size_t slot = hash & table->slot_mask;
+
+	while(1) {
+
+		uint16_t value = __atomic_load_n(&table->slots[slot], __ATOMIC_ACQUIRE);
+
+		if(value == 0) {
+
+			*slot_value = 0;
+			return slot;
+		}
+
+		const char * key = table->entries[value - 1].key;
+
+		if(memcmp(key, string, length) == 0 && key[length] == '\0') {
+
+			*slot_value = value;
+			return slot;
+		}
+
+		slot = (slot + 1) & table->slot_mask;
+	}
+}
+
+/* Static helper function that returns the entry for an id. */
+static const intern_entry * find_entry(const roman_intern * table, const uint16_t id) {
+
+	if(table == NULL || id >= roman_intern_count(table)) {
+		return NULL;
+	}
+
+	return &table->entries[id];
+}
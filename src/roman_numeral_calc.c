@@ -15,14 +15,103 @@ This file defines library functions that allow the user to add and subtract Roma
 #include <stdbool.h>
 
 #include "roman_numeral_calc.h"
+#include "roman_dfa.h"
+#include "roman_branchless.h"
+#include "roman_render.h"
+#include "roman_probes.h"
 
-/* Static helper function used to shift a C string left, dropping off 
-the first character.  This does not change the allocation size of 
-the string. */
-static void shift_string_left(char * cstring, int shift);
+#if defined(ROMAN_BRANCHLESS_ENGINE)
+
+/* Convert decimal numbers to Roman numerals with the branch-free 
+kernel.  See header file for full description. */
+int convert_decimal_to_roman(const int decimal, char * numeral) {
+
+	ROMAN_PROBE2(convert_decimal_to_roman__entry, decimal, numeral);
+
+	//First check if number is within the accepted range. 
+	if(decimal < MIN_DECIMAL || decimal > MAX_DECIMAL) {
+		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
+		return 1;
+	}
+
+	//Check for a null pointer on numeral string.  
+	if(numeral == NULL) {
+		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
+		return 1;
+	}
+
+	//Look up each decimal place in the digit tables, assembling the 
+	//numeral in a fixed-size slot.  Only the numeral and its null 
+	//character are copied to the caller, so this copy is the one step 
+	//whose length depends on the value; convert_decimal_to_roman_slot() 
+	//stores the whole slot instead.  
+	char slot[ROMAN_NUMERAL_SIZE];
+	size_t length = roman_branchless_render(decimal, slot);
+
+	memcpy(numeral, slot, length + 1);
+
+	//Successful conversion, return success flag value.  
+	ROMAN_PROBE1(convert_decimal_to_roman__return, 0);
+	return 0;
+}
+
+#elif defined(ROMAN_COMPACT_ENGINE)
+
+/* Convert decimal numbers to Roman numerals using the digit tables in 
+"roman_render.h".  See header file for full description. */
+int convert_decimal_to_roman(const int decimal, char * numeral) {
+
+	ROMAN_PROBE2(convert_decimal_to_roman__entry, decimal, numeral);
+
+	//First check if number is within the accepted range. 
+	if(decimal < MIN_DECIMAL || decimal > MAX_DECIMAL) {
+		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
+		return 1;
+	}
+
+	//Check for a null pointer on numeral string.  
+	if(numeral == NULL) {
+		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
+		return 1;
+	}
+
+	//Split the decimal number into its four decimal places.  The 
+	//divisions are by small constants, which the compiler reduces 
+	//to multiplications.  
+	const int digits[4] = {
+		decimal / 1000,
+		(decimal / 100) % 10,
+		(decimal / 10) % 10,
+		decimal % 10
+	};
+
+	//Copy the numeral for each decimal place, from the thousands 
+	//down to the ones, directly into the caller's string.  
+	char * write_ptr = numeral;
+	for(int place=0; place<4; place++) {
+
+		int length = roman_render_length[digits[place]];
+
+		memcpy(write_ptr, roman_render_digit[place][digits[place]], length);
+		write_ptr += length;
+	}
+
+	//Terminate the finished numeral string.  
+	*write_ptr = '\0';
+
+	//Successful conversion, return success flag value.  
+	ROMAN_PROBE1(convert_decimal_to_roman__return, 0);
+	return 0;
+}
+
+#else
 
 //Roman numeral symbols and associated decimal values.  These are 
-//used in the conversion between decimal numbers and Roman numerals.  
+//used in the conversion from decimal numbers to Roman numerals.  
 static const char roman_symbol[] = {'M','D','C','L','X','V','I','\0'};
 static const int decimal_symbol[] = {1000, 500, 100, 50, 10, 5, 1};
 static const int num_symbol = 7;
@@ -30,21 +119,22 @@ static const int num_symbol = 7;
 /* Convert decimal numbers to Roman numerals.  See header file for full description. */
 int convert_decimal_to_roman(const int decimal, char * numeral) {
 
+	ROMAN_PROBE2(convert_decimal_to_roman__entry, decimal, numeral);
+
 	//First check if number is within the accepted range. 
 	if(decimal < MIN_DECIMAL || decimal > MAX_DECIMAL) {
 		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
 		return 1;
 	}
 
 	//Check for a null pointer on numeral string.  
 	if(numeral == NULL) {
 		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
 		return 1;
 	}
 
-	//Ensure the numeral string is clean before writing over it.  
-	memset(numeral, 0, strlen(numeral));
-
 	//Generate buffer string used when generating Roman numerals.  
 	char * buffer = allocate_roman_numeral_string();
 
@@ -152,7 +242,7 @@ int convert_decimal_to_roman(const int decimal, char * numeral) {
 	}
 
 	//Copy contents of buffer to "numeral". 
-	strncpy(numeral, buffer, strlen(buffer)+1);
+	memcpy(numeral, buffer, strlen(buffer)+1);
 
 	//decimal_temp should equal zero now, with all value extracted 
 	//and converted to Roman numerals.  If not, something went 
@@ -160,201 +250,104 @@ int convert_decimal_to_roman(const int decimal, char * numeral) {
 	if(decimal_temp != 0) {
 	
 		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman__return, 1);
 		return 1;
 	}
 
 	free(buffer);
 
 	//Successful conversion, return success flag value.  
+	ROMAN_PROBE1(convert_decimal_to_roman__return, 0);
+	return 0;
+}
+
+#endif
+
+/* Convert decimal numbers to Roman numerals in a whole numeral slot.  
+See header file for full description. */
+int convert_decimal_to_roman_slot(const int decimal, char * numeral) {
+
+	ROMAN_PROBE2(convert_decimal_to_roman_slot__entry, decimal, numeral);
+
+	//Check the range and for a null pointer on numeral string.  
+	if(decimal < MIN_DECIMAL || decimal > MAX_DECIMAL || numeral == NULL) {
+
+		//Failed, return.  
+		ROMAN_PROBE1(convert_decimal_to_roman_slot__return, 1);
+		return 1;
+	}
+
+#ifdef ROMAN_BRANCHLESS_ENGINE
+	//One ROMAN_NUMERAL_SIZE byte store, the same for every value.  
+	roman_branchless_render(decimal, numeral);
+#else
+	//Zero the slot, so the numeral is padded with null characters.  
+	memset(numeral, 0, ROMAN_NUMERAL_SIZE);
+	convert_decimal_to_roman(decimal, numeral);
+#endif
+
+	ROMAN_PROBE1(convert_decimal_to_roman_slot__return, 0);
 	return 0;
 }
 
 /* Convert Roman numerals to decimal numbers.  See header file for full description. */
 int convert_roman_to_decimal(const char * numeral, int * decimal) {
 
+	ROMAN_PROBE2(convert_roman_to_decimal__entry, numeral, decimal);
+
 	//Ensure pointers are not null.  
 	if(numeral == NULL || decimal == NULL) {
 	
 		//Invalid input, conversion fails.  
+		ROMAN_PROBE2(parse__fail, numeral, ROMAN_PROBE_FAIL_NULL);
+		ROMAN_PROBE1(convert_roman_to_decimal__return, 1);
 		return 1;
 	}
 
-	//temporary variable to store decimal number as it is built up 
-	int decimal_temp = 0;
-	
-	//Copy the original numeral to another c string that can be 
-	//manipulated as need.  
-	char * numeral_temp = (char*)malloc(sizeof(char) * (strlen(numeral)+1));
-	memcpy(numeral_temp, numeral, strlen(numeral)+1);
-	
-	//Ensure numeral is in uppercase.   
-	for(int i=0; i<strlen(numeral_temp); i++) {
-		
-		numeral_temp[i] = toupper(numeral_temp[i]);
-	}
-	
-	//Ensure the input string contains valid Roman numeral symbols.  
-	for(int i=0; i<strlen(numeral_temp); i++) {
-		
-		char * location_ptr = strchr(roman_symbol, numeral_temp[i]);
-		
-		//Pointer is null if character not found within roman_symbol.
-		if(location_ptr == NULL) {
-	
-			//Invalid Roman numeral, exit with failure flag.  
-			free(numeral_temp);
-			return 1;
-		}
-	}
-	
-	/* Converting from Roman numerals to decimal numbers follows a 
-	similar approach as the reverse conversion that is described in 
-	"convert_decimal_to_roman()" above.  Within each decimal place,
-	strings representing 9, 5, 4, and 1 are searched for within 
-	"numeral_temp".  As they are identified in leading positions in 
-	the numeral string, they are removed from the front of the 
-	string and their equivalent value is added to the growing 
-	decimal value, stored in "decimal_temp".  */
-	
-	//If the numeral string is preceeded by M's, these represent 
-	//values of 1000.  There should be 3 maximum.  
-	int count=0;
-	while(strchr(numeral_temp,'M') == numeral_temp) {
-	
-		count++;
-	
-		decimal_temp += 1000;
-		
-		shift_string_left(numeral_temp, 1);
-		
-		//Check for more than 3 M's in a row.    
-		if(count > 3) {
-	
-			//Incorrectly formated Roman numeral, return. 
-			free(numeral_temp);
-			return 1;
-		}
-	}
-	
-	//For each decimal place from the 100's to the 1's, search for 
-	//the Roman numerals that represent the respective values of 9, 
-	//5, 4, and 1.  "symbol_iter" starts at 2 because that is the 
-	//index for the 100s decimal value and Roman numeral symbol C.  
-	for(int symbol_iter=2; symbol_iter < num_symbol; symbol_iter+=2) {
-	
-		int decimal_place_value = decimal_symbol[symbol_iter];
-	
-		//Decimal number values representing the four cases of values 
-		//within the current decimal place.  
-		int value_nine = 9 * decimal_place_value;
-		int value_five = 5 * decimal_place_value;
-		int value_four = 4 * decimal_place_value;
-		int value_one = decimal_place_value;
-	
-		//Roman numeral strings that correspond to the above decimal 
-		//values.  All are null-terimated c strings.  Memory 
-		//allocated on stack, not heap, to reduce complexity.  
-		char numeral_str_nine[] = {'\0', '\0', '\0'};
-		numeral_str_nine[0] = roman_symbol[symbol_iter];
-		numeral_str_nine[1] = roman_symbol[symbol_iter-2];
-		
-		char numeral_str_five[] = {'\0', '\0'};
-		numeral_str_five[0] = roman_symbol[symbol_iter-1];
-		
-		char numeral_str_four[] = {'\0', '\0', '\0'};
-		numeral_str_four[0] = roman_symbol[symbol_iter];
-		numeral_str_four[1] = roman_symbol[symbol_iter-1];
-		
-		char numeral_str_one[] = {'\0', '\0'};
-		numeral_str_one[0] = roman_symbol[symbol_iter];
-	
-		//Check for numeral string that represents the 9 value.   	
-		if(strstr(numeral_temp, numeral_str_nine)) {
-	
-			//Check if the string is at beginning.  
-			if(strstr(numeral_temp, numeral_str_nine) == numeral_temp) {
-		
-				decimal_temp += value_nine;
-				
-				shift_string_left(numeral_temp, 2);
-			}
-			else {
-			
-				//Incorrectly formated Roman numeral, return. 
-				free(numeral_temp);
-				return 1;
-			}
-		}
-	
-		//Check for numeral for 5, not necessarily at the beginning.  
-		if(strstr(numeral_temp, numeral_str_five)) {
-	
-			//Check for leading 5 numeral.  
-			if(strstr(numeral_temp, numeral_str_five) == numeral_temp) {
-			
-				decimal_temp += value_five;
-		
-				shift_string_left(numeral_temp, 1);
-			}
-			//Check for leading numeral for 4 value.
-			else if(strstr(numeral_temp, numeral_str_four) == numeral_temp) {
-				  
-			
-				decimal_temp += value_four;
-		
-				shift_string_left(numeral_temp, 2);
-			
-				//With leading numerals for 4 value, there should be 
-				//no immediately following numeral for the 1 value.
-				if(strstr(numeral_temp, numeral_str_one) == numeral_temp) {			
-					//Incorrectly formated Roman numeral, return. 
-					free(numeral_temp);
-					return 1;
-				}
-			}
-			else {
-			
-				//Incorrectly formated Roman numeral, return. 
-				free(numeral_temp);
-				return 1;
-			}
-		}
-	
-		//If the string starts with numerals for the 1 value, here 
-		//should be 3 maximum.  
-		int count=0;
-		while(strstr(numeral_temp, numeral_str_one) == numeral_temp) {
-		
-			count++;
-	
-			decimal_temp += value_one;
-		
-			shift_string_left(numeral_temp, 1);
-		
-			//Check for more than 3 consecutive numerals for the 
-			//1 value.
-			if(count > 3) {
-		
-				//Incorrectly formated Roman numeral, return. 
-				free(numeral_temp);
-				return 1;
-			}
-		}
+	/* The numeral is validated and converted in a single pass by the 
+	incremental validator (see "roman_dfa.h"), which applies the same 
+	rules per decimal place as "convert_decimal_to_roman()" above: up 
+	to three numerals for the 1 value, a leading numeral for the 5 
+	value, or the numerals for the 4 and 9 values, with the decimal 
+	places in descending order.  Symbols are read one at a time from 
+	the caller's string, in either case, with no copy.  The parse stops 
+	at the first symbol that cannot follow the ones before it, and a 
+	string longer than MAX_LENGTH_ROMAN is rejected once its first 
+	strlen(MAX_LENGTH_ROMAN)+1 characters have been read, so the cost 
+	of rejecting oversized input does not depend on its length. */
+#ifdef ROMAN_BRANCHLESS_ENGINE
+	//The branchless engine parses with a fixed number of steps and a 
+	//canonical form check instead (see "roman_branchless.h").  It 
+	//reads no more of the string than the validator.  
+	int decimal_temp = roman_branchless_parse(numeral);
+#else
+	int decimal_temp = roman_dfa_parse(numeral);
+#endif
+
+	if(decimal_temp < MIN_DECIMAL) {
+
+		//Incorrectly formated Roman numeral, return.  Strings too 
+		//long to be any numeral are reported separately.  
+		ROMAN_PROBE2(parse__fail, numeral, roman_probe_fail_reason(numeral));
+		ROMAN_PROBE1(convert_roman_to_decimal__return, 1);
+		return 1;
 	}
-	
-	free(numeral_temp);
 
 	//Store the final converted decimal number.  
 	*decimal = decimal_temp;
 
+	ROMAN_PROBE1(convert_roman_to_decimal__return, 0);
 	return 0;
 }
 
 /* Add two Roman numerals.  See header file for full description. */
 int roman_addition(const char * numeral_a, const char * numeral_b, char * numeral_sum) {
 
+	ROMAN_PROBE3(roman_addition__entry, numeral_a, numeral_b, numeral_sum);
+
 	if(numeral_a == NULL || numeral_b == NULL || numeral_sum == NULL) {
 		//Addition failed, due to invalid input.  
+		ROMAN_PROBE1(roman_addition__return, 1);
 		return 1;
 	}
 	
@@ -366,6 +359,7 @@ int roman_addition(const char * numeral_a, const char * numeral_b, char * numera
 	if(convert_roman_to_decimal(numeral_a, &decimal_a) || convert_roman_to_decimal(numeral_b, &decimal_b)) {
 	
 		//Addition failed, due to conversion failure.  
+		ROMAN_PROBE1(roman_addition__return, 1);
 		return 1;
 	}
 	
@@ -374,23 +368,29 @@ int roman_addition(const char * numeral_a, const char * numeral_b, char * numera
 	if(decimal_sum > MAX_DECIMAL) {
 	
 		//Addition failed, due to invalid sum.  
+		ROMAN_PROBE1(roman_addition__return, 1);
 		return 1;
 	}
 	
 	if(convert_decimal_to_roman(decimal_sum, numeral_sum)) {
 	
 		//Addition failed, due to conversion failure.  
+		ROMAN_PROBE1(roman_addition__return, 1);
 		return 1;
 	}
 
+	ROMAN_PROBE1(roman_addition__return, 0);
 	return 0;
 }
 
 /* Subtract two Roman numerals.  See header file for full description. */
 int roman_subtraction(const char * numeral_a, const char * numeral_b, char * numeral_diff) {
 
+	ROMAN_PROBE3(roman_subtraction__entry, numeral_a, numeral_b, numeral_diff);
+
 	if(numeral_a == NULL || numeral_b == NULL || numeral_diff == NULL) {
 		//Subtraction failed, due to invalid input.  
+		ROMAN_PROBE1(roman_subtraction__return, 1);
 		return 1;
 	}
 	
@@ -402,6 +402,7 @@ int roman_subtraction(const char * numeral_a, const char * numeral_b, char * num
 	if(convert_roman_to_decimal(numeral_a, &decimal_a) || convert_roman_to_decimal(numeral_b, &decimal_b)) {
 	
 		//Subtraction failed, due to conversion failure.  
+		ROMAN_PROBE1(roman_subtraction__return, 1);
 		return 1;
 	}
 	
@@ -410,15 +411,18 @@ int roman_subtraction(const char * numeral_a, const char * numeral_b, char * num
 	if(decimal_diff < 1) {
 	
 		//Subtraction failed, due to invalid result.  
+		ROMAN_PROBE1(roman_subtraction__return, 1);
 		return 1;
 	}
 	
 	if(convert_decimal_to_roman(decimal_diff, numeral_diff)) {
 	
 		//Subtraction failed, due to conversion failure.  
+		ROMAN_PROBE1(roman_subtraction__return, 1);
 		return 1;
 	}
 
+	ROMAN_PROBE1(roman_subtraction__return, 0);
 	return 0;
 }
 
@@ -426,22 +430,12 @@ int roman_subtraction(const char * numeral_a, const char * numeral_b, char * num
 file for more detailed description. */
 char * allocate_roman_numeral_string() {
 
+	ROMAN_PROBE0(allocate_roman_numeral_string__entry);
+
 	//Allocate the string, set contents to zero, and return pointer. 
 	char * temp_string = (char*)malloc(sizeof(char) + (strlen(MAX_LENGTH_ROMAN)+1));
 	memset(temp_string, 0, (strlen(MAX_LENGTH_ROMAN)+1));
 
+	ROMAN_PROBE1(allocate_roman_numeral_string__return, temp_string);
 	return temp_string;
 }
-
-/* Static helper function used to shift a C string left, dropping off 
-the first character.  This does not change the allocation size of 
-the string. */
-static void shift_string_left(char * cstring, int shift) {
-
-	//Shift one place at a time to maintain null terminator.  
-	for(int i=0; i<shift; i++) {
-		memmove(cstring, cstring+1, strlen(cstring));
-	}
-}
-
-
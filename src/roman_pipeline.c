@@ -0,0 +1,531 @@
+/*
+roman_pipeline.c
+
+This file defines the pipelined arithmetic engine of the Roman numeral calculator library.  Three threads (parse, compute and render) are chained by three queues: the producer feeds input records to the parse thread, which feeds parsed operands to the compute thread, which feeds results to the render thread.  Each queue is a ring of preallocated batch slots with one producer and one consumer, synchronised only by its head and tail counters (release stores and acquire loads).  The last batch of the stream carries an end flag, which each thread passes on before it exits.
+
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_pipeline.h"
+#include "roman_probes.h"
+
+//Assumed size of a cache line, used to keep the counters of a queue
+//apart so the producer and consumer do not share a line.
+#define CACHE_LINE 64
+
+//Number of times a waiting thread spins before yielding the CPU.
+#define SPIN_LIMIT 64
+
+/* Header at the start of every batch slot, followed by the records. */
+typedef struct {
+	size_t count;
+	int end;
+} batch_header;
+
+/* Record passed from the parse thread to the compute thread. */
+typedef struct {
+	int decimal_a;
+	int decimal_b;
+	int operation;
+	int status;
+} parsed_record;
+
+/* Record passed from the compute thread to the render thread. */
+typedef struct {
+	int decimal;
+	int status;
+} computed_record;
+
+/* A single-producer/single-consumer queue of batch slots.  "head"
+counts the slots published by the producer and "tail" the slots
+released by the consumer; slot i lives at (i & mask) * slot_size.  The
+fields that never change, "head" and "tail" each have their own cache
+line. */
+typedef struct {
+	char * slots;
+	size_t slot_size;
+	size_t mask;
+	char fixed_pad[CACHE_LINE - sizeof(char*) - 2 * sizeof(size_t)];
+	size_t head;
+	char head_pad[CACHE_LINE - sizeof(size_t)];
+	size_t tail;
+	char tail_pad[CACHE_LINE - sizeof(size_t)];
+} batch_queue;
+
+/* Queues between the stages, in stream order. */
+enum {
+	QUEUE_INPUT,
+	QUEUE_PARSED,
+	QUEUE_COMPUTED,
+	NUM_QUEUES
+};
+
+/* Pipeline state.  "current" is the input slot being filled by the
+producer, or NULL if none is claimed. */
+struct roman_pipeline {
+	batch_queue queues[NUM_QUEUES];
+	pthread_t threads[NUM_QUEUES];
+	size_t batch_size;
+	int backpressure;
+	batch_header * current;
+	roman_pipeline_callback callback;
+	void * context;
+};
+
+/* Static helper functions that set up and release a queue for records
+of "record_size" bytes. */
+static int init_queue(batch_queue * queue, size_t batches, size_t batch_size, size_t record_size);
+static void free_queue(batch_queue * queue);
+
+/* Static helper function used by a queue's producer to claim the next
+free slot, waiting for one if "block" is set.  Returns NULL if the
+queue is full and "block" is not set. */
+static batch_header * claim_slot(batch_queue * queue, int block);
+
+/* Static helper function used by a queue's producer to publish the
+slot it claimed. */
+static void publish_slot(batch_queue * queue);
+
+/* Static helper function used by a queue's consumer to wait for the
+next published slot. */
+static batch_header * next_slot(batch_queue * queue);
+
+/* Static helper function used by a queue's consumer to release the
+slot it has finished with. */
+static void release_slot(batch_queue * queue);
+
+/* Static helper function that waits a little, spinning at first and
+then yielding the CPU. */
+static void wait_briefly(int * spins);
+
+/* Thread functions of the three stages. */
+static void * parse_stage(void * arg);
+static void * compute_stage(void * arg);
+static void * render_stage(void * arg);
+
+/* Returns the records following a batch header. */
+#define BATCH_RECORDS(header, type) ((type*)((char*)(header) + sizeof(batch_header)))
+
+/* Start a pipeline.  See header file for full description. */
+roman_pipeline * roman_pipeline_start(const roman_pipeline_config * config, roman_pipeline_callback callback, void * context) {
+
+	ROMAN_PROBE3(roman_pipeline_start__entry, config, callback, context);
+
+	size_t batch_size = ROMAN_PIPELINE_DEFAULT_BATCH;
+	size_t queue_batches = ROMAN_PIPELINE_DEFAULT_QUEUE;
+	int backpressure = ROMAN_PIPELINE_BLOCK;
+
+	if(config != NULL) {
+
+		batch_size = config->batch_size ? config->batch_size : batch_size;
+		queue_batches = config->queue_batches ? config->queue_batches : queue_batches;
+		backpressure = config->backpressure;
+	}
+
+	if(callback == NULL || (backpressure != ROMAN_PIPELINE_BLOCK && backpressure != ROMAN_PIPELINE_REJECT)
+		|| batch_size > ((size_t)1 << 24) || queue_batches > ((size_t)1 << 16)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_pipeline_start__return, NULL);
+		return NULL;
+	}
+
+	roman_pipeline * pipeline = (roman_pipeline*)calloc(1, sizeof(roman_pipeline));
+	if(pipeline == NULL) {
+		ROMAN_PROBE1(roman_pipeline_start__return, NULL);
+		return NULL;
+	}
+
+	pipeline->batch_size = batch_size;
+	pipeline->backpressure = backpressure;
+	pipeline->callback = callback;
+	pipeline->context = context;
+
+	static const size_t record_size[NUM_QUEUES] = {
+		sizeof(roman_pipeline_input), sizeof(parsed_record), sizeof(computed_record)
+	};
+
+	int failure_flag = 0;
+	for(int i=0; i<NUM_QUEUES; i++) {
+		failure_flag |= init_queue(&pipeline->queues[i], queue_batches, batch_size, record_size[i]);
+	}
+
+	if(failure_flag) {
+
+		for(int i=0; i<NUM_QUEUES; i++) {
+			free_queue(&pipeline->queues[i]);
+		}
+		free(pipeline);
+		ROMAN_PROBE1(roman_pipeline_start__return, NULL);
+		return NULL;
+	}
+
+	//Start the stages from the end of the stream, so a stage that
+	//fails to start never leaves an earlier stage waiting.
+	void * (*stage[NUM_QUEUES])(void *) = {parse_stage, compute_stage, render_stage};
+	int started = NUM_QUEUES;
+
+	while(started > 0 && pthread_create(&pipeline->threads[started-1], NULL, stage[started-1], pipeline) == 0) {
+		started--;
+	}
+
+	if(started > 0) {
+
+		//End the stages that did start by sending an empty final batch
+		//into the first running stage's queue.
+		if(started < NUM_QUEUES) {
+
+			batch_header * header = claim_slot(&pipeline->queues[started], 1);
+			header->count = 0;
+			header->end = 1;
+			publish_slot(&pipeline->queues[started]);
+
+			for(int i=started; i<NUM_QUEUES; i++) {
+				pthread_join(pipeline->threads[i], NULL);
+			}
+		}
+
+		for(int i=0; i<NUM_QUEUES; i++) {
+			free_queue(&pipeline->queues[i]);
+		}
+		free(pipeline);
+		ROMAN_PROBE1(roman_pipeline_start__return, NULL);
+		return NULL;
+	}
+
+	ROMAN_PROBE1(roman_pipeline_start__return, pipeline);
+	return pipeline;
+}
+
+/* Submit records.  See header file for full description. */
+int roman_pipeline_submit(roman_pipeline * pipeline, const roman_pipeline_input * records, const size_t count, size_t * accepted) {
+
+	ROMAN_PROBE3(roman_pipeline_submit__entry, pipeline, records, count);
+
+	size_t taken = 0;
+
+	if(pipeline == NULL || (records == NULL && count > 0)) {
+
+		//Invalid input.
+		if(accepted != NULL) {
+			*accepted = 0;
+		}
+		ROMAN_PROBE1(roman_pipeline_submit__return, 1);
+		return 1;
+	}
+
+	batch_queue * queue = &pipeline->queues[QUEUE_INPUT];
+
+	while(taken < count) {
+
+		if(pipeline->current == NULL) {
+
+			pipeline->current = claim_slot(queue, pipeline->backpressure == ROMAN_PIPELINE_BLOCK);
+
+			if(pipeline->current == NULL) {
+
+				//Queue full, reject the rest.
+				break;
+			}
+
+			pipeline->current->count = 0;
+			pipeline->current->end = 0;
+		}
+
+		batch_header * header = pipeline->current;
+		size_t room = pipeline->batch_size - header->count;
+		size_t copy = count - taken < room ? count - taken : room;
+
+		memcpy(BATCH_RECORDS(header, roman_pipeline_input) + header->count, records + taken, copy * sizeof(roman_pipeline_input));
+		header->count += copy;
+		taken += copy;
+
+		if(header->count == pipeline->batch_size) {
+
+			publish_slot(queue);
+			pipeline->current = NULL;
+		}
+	}
+
+	if(accepted != NULL) {
+		*accepted = taken;
+	}
+
+	int failure_flag = taken != count;
+
+	ROMAN_PROBE1(roman_pipeline_submit__return, failure_flag);
+	return failure_flag;
+}
+
+/* Send a partial batch.  See header file for full description. */
+void roman_pipeline_flush(roman_pipeline * pipeline) {
+
+	ROMAN_PROBE1(roman_pipeline_flush__entry, pipeline);
+
+	if(pipeline == NULL || pipeline->current == NULL || pipeline->current->count == 0) {
+		ROMAN_PROBE0(roman_pipeline_flush__return);
+		return;
+	}
+
+	publish_slot(&pipeline->queues[QUEUE_INPUT]);
+	pipeline->current = NULL;
+
+	ROMAN_PROBE0(roman_pipeline_flush__return);
+}
+
+/* Finish the stream and release the pipeline.  See header file for
+full description. */
+int roman_pipeline_finish(roman_pipeline * pipeline) {
+
+	ROMAN_PROBE1(roman_pipeline_finish__entry, pipeline);
+
+	if(pipeline == NULL) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_pipeline_finish__return, 1);
+		return 1;
+	}
+
+	//The final batch carries the end flag, with or without records.
+	//It is always waited for, whatever the backpressure setting.
+	if(pipeline->current == NULL) {
+
+		pipeline->current = claim_slot(&pipeline->queues[QUEUE_INPUT], 1);
+		pipeline->current->count = 0;
+	}
+
+	pipeline->current->end = 1;
+	publish_slot(&pipeline->queues[QUEUE_INPUT]);
+
+	for(int i=0; i<NUM_QUEUES; i++) {
+		pthread_join(pipeline->threads[i], NULL);
+	}
+
+	for(int i=0; i<NUM_QUEUES; i++) {
+		free_queue(&pipeline->queues[i]);
+	}
+
+	free(pipeline);
+
+	ROMAN_PROBE1(roman_pipeline_finish__return, 0);
+	return 0;
+}
+
+/* Static helper function that sets up a queue.  Slots are rounded up
+to whole cache lines, so neighbouring slots never share a line. */
+static int init_queue(batch_queue * queue, size_t batches, size_t batch_size, size_t record_size) {
+
+	size_t slot_count = 1;
+	while(slot_count < batches) {
+		slot_count <<= 1;
+	}
+
+	size_t slot_size = sizeof(batch_header) + batch_size * record_size;
+	slot_size = (slot_size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+
+	queue->head = 0;
+	queue->tail = 0;
+	queue->slots = (char*)malloc(slot_count * slot_size);
+	queue->slot_size = slot_size;
+	queue->mask = slot_count - 1;
+
+	return queue->slots == NULL;
+}
+
+/* Static helper function that releases a queue. */
+static void free_queue(batch_queue * queue) {
+
+	free(queue->slots);
+	queue->slots = NULL;
+}
+
+/* Static helper function that claims the next free slot.  Only the
+producer writes "head", so it is read without ordering. */
+static batch_header * claim_slot(batch_queue * queue, int block) {
+
+	size_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	int spins = 0;
+
+	while(head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) > queue->mask) {
+
+		if(!block) {
+
+			//Queue full.
+			return NULL;
+		}
+
+		wait_briefly(&spins);
+	}
+
+	return (batch_header*)(queue->slots + (head & queue->mask) * queue->slot_size);
+}
+
+/* Static helper function that publishes the claimed slot, making its
+contents visible to the consumer. */
+static void publish_slot(batch_queue * queue) {
+
+	__atomic_store_n(&queue->head, __atomic_load_n(&queue->head, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+/* Static helper function that waits for the next published slot. */
+static batch_header * next_slot(batch_queue * queue) {
+
+	size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+	int spins = 0;
+
+	while(__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == tail) {
+		wait_briefly(&spins);
+	}
+
+	return (batch_header*)(queue->slots + (tail & queue->mask) * queue->slot_size);
+}
+
+/* Static helper function that hands a finished slot back to the
+producer. */
+static void release_slot(batch_queue * queue) {
+
+	__atomic_store_n(&queue->tail, __atomic_load_n(&queue->tail, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+/* Static helper function that waits a little. */
+static void wait_briefly(int * spins) {
+
+	if(*spins < SPIN_LIMIT) {
+		(*spins)++;
+	}
+	else {
+		sched_yield();
+	}
+}
+
+/* Parse stage: converts both operands of every record to decimal. */
+static void * parse_stage(void * arg) {
+
+	roman_pipeline * pipeline = (roman_pipeline*)arg;
+	batch_queue * input = &pipeline->queues[QUEUE_INPUT];
+	batch_queue * output = &pipeline->queues[QUEUE_PARSED];
+	int end = 0;
+
+	while(!end) {
+
+		batch_header * in = next_slot(input);
+		batch_header * out = claim_slot(output, 1);
+		const roman_pipeline_input * records = BATCH_RECORDS(in, roman_pipeline_input);
+		parsed_record * parsed = BATCH_RECORDS(out, parsed_record);
+
+		for(size_t i=0; i<in->count; i++) {
+
+			parsed[i].operation = records[i].operation;
+			parsed[i].status = convert_roman_to_decimal(records[i].numeral_a, &parsed[i].decimal_a)
+				| convert_roman_to_decimal(records[i].numeral_b, &parsed[i].decimal_b);
+		}
+
+		out->count = in->count;
+		out->end = end = in->end;
+
+		release_slot(input);
+		publish_slot(output);
+	}
+
+	return NULL;
+}
+
+/* Compute stage: adds or subtracts the operands, with the range rules
+of roman_addition() and roman_subtraction(). */
+static void * compute_stage(void * arg) {
+
+	roman_pipeline * pipeline = (roman_pipeline*)arg;
+	batch_queue * input = &pipeline->queues[QUEUE_PARSED];
+	batch_queue * output = &pipeline->queues[QUEUE_COMPUTED];
+	int end = 0;
+
+	while(!end) {
+
+		batch_header * in = next_slot(input);
+		batch_header * out = claim_slot(output, 1);
+		const parsed_record * parsed = BATCH_RECORDS(in, parsed_record);
+		computed_record * computed = BATCH_RECORDS(out, computed_record);
+
+		for(size_t i=0; i<in->count; i++) {
+
+			int decimal = parsed[i].operation == ROMAN_PIPELINE_SUBTRACT
+				? parsed[i].decimal_a - parsed[i].decimal_b
+				: parsed[i].decimal_a + parsed[i].decimal_b;
+
+			int failed = parsed[i].status
+				|| (parsed[i].operation != ROMAN_PIPELINE_ADD && parsed[i].operation != ROMAN_PIPELINE_SUBTRACT)
+				|| decimal < MIN_DECIMAL || decimal > MAX_DECIMAL;
+
+			computed[i].decimal = failed ? 0 : decimal;
+			computed[i].status = failed;
+		}
+
+		out->count = in->count;
+		out->end = end = in->end;
+
+		release_slot(input);
+		publish_slot(output);
+	}
+
+	return NULL;
+}
+
+/* Render stage: converts the results to Roman numerals and passes each
+batch to the callback. */
+static void * render_stage(void * arg) {
+
+	roman_pipeline * pipeline = (roman_pipeline*)arg;
+	batch_queue * input = &pipeline->queues[QUEUE_COMPUTED];
+	int end = 0;
+
+	//Output records are built here, then handed to the callback.  If
+	//the allocation fails, results are passed one at a time.
+	roman_pipeline_output single;
+	roman_pipeline_output * outputs = (roman_pipeline_output*)malloc(sizeof(roman_pipeline_output) * pipeline->batch_size);
+	size_t capacity = outputs != NULL ? pipeline->batch_size : 1;
+
+	if(outputs == NULL) {
+		outputs = &single;
+	}
+
+	while(!end) {
+
+		batch_header * in = next_slot(input);
+		const computed_record * computed = BATCH_RECORDS(in, computed_record);
+
+		for(size_t base=0; base<in->count; base+=capacity) {
+
+			size_t rows = in->count - base < capacity ? in->count - base : capacity;
+
+			for(size_t i=0; i<rows; i++) {
+
+				outputs[i].decimal = computed[base+i].decimal;
+				outputs[i].status = computed[base+i].status;
+				outputs[i].numeral[0] = '\0';
+
+				if(!outputs[i].status) {
+					convert_decimal_to_roman_slot(outputs[i].decimal, outputs[i].numeral);
+				}
+			}
+
+			pipeline->callback(outputs, rows, pipeline->context);
+		}
+
+		end = in->end;
+		release_slot(input);
+	}
+
+	if(outputs != &single) {
+		free(outputs);
+	}
+
+	return NULL;
+}
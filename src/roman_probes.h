@@ -0,0 +1,84 @@
+/*
+roman_probes.h
+
+Private header for the static tracepoints of libromancalc.  It is not
+installed with the library.
+
+*/
+
+#ifndef ROMAN_PROBES_H
+#define ROMAN_PROBES_H
+
+#include <string.h>
+
+#include "roman_numeral_calc.h"
+
+/* Static tracepoints (systemtap-style USDT probes) under the provider
+"libromancalc", for attaching bpftrace, perf or systemtap to a running
+program.  When <sys/sdt.h> is available the probes are compiled in:
+each one is a single no-op instruction plus a note in the object file
+recording where its arguments live, so a probe costs nothing until a
+tracer attaches to it.  Otherwise (or if ROMAN_NO_PROBES is defined)
+the probes compile to nothing.
+
+Probe arguments must be integers or pointers and should be values that
+are already at hand, as they are computed even when no tracer is
+attached.  Public functions fire "<function>__entry" with their inputs
+and "<function>__return" with their result ('0' or '1' like the
+function itself, the returned pointer, or nothing if the function
+returns no value), and the converter fires "parse__fail" with the
+numeral and one of the ROMAN_PROBE_FAIL_* reasons below before
+returning a failure.
+
+Every public function that parses, computes or renders is probed, as
+is allocate_roman_numeral_string(), one of the original converter
+functions.  Functions that only allocate, release, reset or initialise
+a structure (allocate_roman_accumulator, _intern and _arena, free_*,
+*_reset, roman_stream_init, roman_thread_arena, roman_table_close),
+hand out arena buffers (roman_arena_numeral and _numerals) or read a
+stored value without any conversion (roman_accumulator_decimal,
+roman_intern_count, _string, _decimal and _numeral, roman_arena_used
+and _capacity, roman_table_numeral) are left out on purpose, as they
+run in constant time and do no conversion work. */
+#if !defined(ROMAN_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ROMAN_HAVE_PROBES 1
+#endif
+#endif
+
+#ifdef ROMAN_HAVE_PROBES
+#define ROMAN_PROBE0(name) DTRACE_PROBE(libromancalc, name)
+#define ROMAN_PROBE1(name, arg1) DTRACE_PROBE1(libromancalc, name, arg1)
+#define ROMAN_PROBE2(name, arg1, arg2) DTRACE_PROBE2(libromancalc, name, arg1, arg2)
+#define ROMAN_PROBE3(name, arg1, arg2, arg3) DTRACE_PROBE3(libromancalc, name, arg1, arg2, arg3)
+#define ROMAN_PROBE4(name, arg1, arg2, arg3, arg4) DTRACE_PROBE4(libromancalc, name, arg1, arg2, arg3, arg4)
+#else
+#define ROMAN_PROBE0(name) do {} while(0)
+#define ROMAN_PROBE1(name, arg1) do {} while(0)
+#define ROMAN_PROBE2(name, arg1, arg2) do {} while(0)
+#define ROMAN_PROBE3(name, arg1, arg2, arg3) do {} while(0)
+#define ROMAN_PROBE4(name, arg1, arg2, arg3, arg4) do {} while(0)
+#endif
+
+/* Reasons given by the "parse__fail" probe: a null pointer, a string
+that is not a valid numeral, or one too long to be any numeral. */
+#define ROMAN_PROBE_FAIL_NULL 1
+#define ROMAN_PROBE_FAIL_INVALID 2
+#define ROMAN_PROBE_FAIL_OVERSIZED 3
+
+/* Returns the "parse__fail" reason for a string the converter has
+rejected.  Like the converter, it reads at most MAX_LENGTH_ROMAN plus
+one characters, and it is only called on the failure path. */
+static inline int roman_probe_fail_reason(const char * numeral) {
+
+	size_t length = 0;
+
+	while(length <= strlen(MAX_LENGTH_ROMAN) && numeral[length] != '\0') {
+		length++;
+	}
+
+	return length > strlen(MAX_LENGTH_ROMAN) ? ROMAN_PROBE_FAIL_OVERSIZED : ROMAN_PROBE_FAIL_INVALID;
+}
+
+#endif
@@ -0,0 +1,17 @@
+/*
+roman_render.c
+
+This file defines the digit tables used by the fixed-size numeral writer in "roman_render.h".
+
+*/
+
+#include "roman_render.h"
+
+const char roman_render_digit[4][10][4] = {
+	{"", "M", "MM", "MMM", "", "", "", "", "", ""},
+	{"", "C", "CC", "CCC", "CD", "D", "DC", "DCC", "DCCC", "CM"},
+	{"", "X", "XX", "XXX", "XL", "L", "LX", "LXX", "LXXX", "XC"},
+	{"", "I", "II", "III", "IV", "V", "VI", "VII", "VIII", "IX"}
+};
+
+const unsigned char roman_render_length[10] = {0, 1, 2, 3, 2, 1, 2, 3, 4, 2};
@@ -0,0 +1,53 @@
+/*
+roman_render.h
+
+Private header for the fixed-size numeral writer used by the bulk
+functions of libromancalc.  It is not installed with the library.
+
+*/
+
+#ifndef ROMAN_RENDER_H
+#define ROMAN_RENDER_H
+
+#include <stddef.h>
+#include <string.h>
+
+/* Numeral of each digit in each decimal place, from the thousands down
+to the ones, stored without a null terminator in 4 byte slots ("VIII"
+fills its slot exactly), and the length of each digit's numeral (the
+same for every place).  Only the first four entries of the thousands
+table are used, as the largest decimal number allowed is 3999.  Total
+size is 4*10*4 + 10 = 170 bytes.  The compact engine renders from these
+tables too. */
+extern const char roman_render_digit[4][10][4];
+extern const unsigned char roman_render_length[10];
+
+/* Write the Roman numeral for "decimal" (1-3999) to "numeral", which
+must have room for ROMAN_NUMERAL_SIZE bytes.  Every decimal place is
+written with a fixed 4 byte copy, so the whole numeral is four stores
+and no length-dependent branches, and the null terminator is placed
+after the true length.  A "decimal" of 0 writes an empty string.
+Returns the length of the numeral. */
+static inline size_t roman_render_fixed(const int decimal, char * numeral) {
+
+	const int digits[4] = {
+		decimal / 1000,
+		(decimal / 100) % 10,
+		(decimal / 10) % 10,
+		decimal % 10
+	};
+
+	size_t length = 0;
+
+	for(int place=0; place<4; place++) {
+
+		memcpy(numeral + length, roman_render_digit[place][digits[place]], 4);
+		length += roman_render_length[digits[place]];
+	}
+
+	numeral[length] = '\0';
+
+	return length;
+}
+
+#endif
@@ -0,0 +1,244 @@
+/*
+roman_scan.c
+
+This file defines the Roman numeral text scanner.  The buffer is processed in blocks of 64 bytes.  Each block is classified into a bitmask of Roman numeral symbol bytes and a bitmask of word bytes, and from those a bitmask of the symbols that start a word.  Only those positions are parsed, so text without numerals is skipped a block at a time.  The classification uses SSE2 where the compiler targets it, and the byte class table otherwise.
+
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "roman_scan.h"
+#include "roman_dfa.h"
+#include "roman_probes.h"
+
+//Number of bytes classified at a time.
+#define BLOCK_SIZE 64
+
+//State used by roman_scan_array() to store matches.
+typedef struct {
+	roman_scan_match * matches;
+	size_t capacity;
+	size_t count;
+} scan_array_state;
+
+/* Static helper functions that build the symbol and word bitmasks of a
+block, bit i describing byte i. */
+static void classify_block_scalar(const unsigned char * block, size_t length, int flags, uint64_t * symbol_bits, uint64_t * word_bits);
+#ifdef __SSE2__
+static void classify_block_sse2(const unsigned char * block, int flags, uint64_t * symbol_bits, uint64_t * word_bits);
+#endif
+
+/* Static helper function, the roman_scan() callback of roman_scan_array(). */
+static int store_match(size_t offset, size_t length, int decimal, void * context);
+
+/* Find every Roman numeral in a buffer.  See header file for full
+description. */
+int roman_scan(const char * buffer, size_t length, int flags, roman_scan_callback callback, void * context) {
+
+	ROMAN_PROBE3(roman_scan__entry, buffer, length, flags);
+
+	if(callback == NULL || (buffer == NULL && length > 0)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_scan__return, 1);
+		return 1;
+	}
+
+	const unsigned char * bytes = (const unsigned char *)buffer;
+	const int uppercase_only = flags & ROMAN_SCAN_UPPERCASE_ONLY;
+
+	//Whether the byte before the current block is a word byte.
+	uint64_t previous_word = 0;
+
+	//Position of the first byte not yet consumed by a symbol run.
+	size_t next = 0;
+
+	for(size_t block=0; block<length; block+=BLOCK_SIZE) {
+
+		size_t block_length = length - block < BLOCK_SIZE ? length - block : BLOCK_SIZE;
+		uint64_t symbol_bits;
+		uint64_t word_bits;
+
+#ifdef __SSE2__
+		if(block_length == BLOCK_SIZE) {
+			classify_block_sse2(bytes + block, flags, &symbol_bits, &word_bits);
+		}
+		else {
+			classify_block_scalar(bytes + block, block_length, flags, &symbol_bits, &word_bits);
+		}
+#else
+		classify_block_scalar(bytes + block, block_length, flags, &symbol_bits, &word_bits);
+#endif
+
+		//Symbols that start a word.
+		uint64_t candidates = symbol_bits & ~((word_bits << 1) | previous_word);
+		previous_word = word_bits >> (BLOCK_SIZE - 1);
+
+		//Drop candidates already consumed by a run from a previous block.
+		if(next > block) {
+			candidates = next - block >= BLOCK_SIZE ? 0 : candidates & (~(uint64_t)0 << (next - block));
+		}
+
+		while(candidates != 0) {
+
+			size_t start = block + (size_t)__builtin_ctzll(candidates);
+			size_t end = start;
+			unsigned int state = ROMAN_DFA_START;
+			int decimal = 0;
+			int invalid = 0;
+
+			//Parse the run of symbols starting the word.
+			while(end < length) {
+
+				int code = roman_byte_class[bytes[end]] & ROMAN_CLASS_SYMBOL_MASK;
+
+				if(code == 0 || (uppercase_only && (bytes[end] & 0x20))) {
+					break;
+				}
+
+				if(!invalid && roman_dfa_step(&state, &decimal, code - 1)) {
+					invalid = 1;
+				}
+
+				end++;
+			}
+
+			//The run must also end the word.
+			if(!invalid && (end == length || !(roman_byte_class[bytes[end]] & ROMAN_CLASS_WORD))) {
+
+				if(callback(start, end - start, decimal, context)) {
+
+					//Stopped by the caller.
+					ROMAN_PROBE1(roman_scan__return, 0);
+					return 0;
+				}
+			}
+
+			//Continue after the run.
+			next = end;
+			candidates = next - block >= BLOCK_SIZE ? 0 : candidates & (~(uint64_t)0 << (next - block));
+		}
+	}
+
+	ROMAN_PROBE1(roman_scan__return, 0);
+	return 0;
+}
+
+/* Find Roman numerals, storing them in an array.  See header file for
+full description. */
+int roman_scan_array(const char * buffer, size_t length, int flags, roman_scan_match * matches, size_t capacity, size_t * count) {
+
+	ROMAN_PROBE3(roman_scan_array__entry, buffer, length, flags);
+
+	if(count == NULL || (matches == NULL && capacity > 0)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_scan_array__return, 1);
+		return 1;
+	}
+
+	scan_array_state state = {matches, capacity, 0};
+	*count = 0;
+
+	if(capacity == 0) {
+
+		//Nothing can be stored.
+		ROMAN_PROBE1(roman_scan_array__return, 0);
+		return 0;
+	}
+
+	int failure_flag = roman_scan(buffer, length, flags, store_match, &state);
+	*count = state.count;
+
+	ROMAN_PROBE1(roman_scan_array__return, failure_flag);
+	return failure_flag;
+}
+
+/* Static helper function that classifies a block of up to BLOCK_SIZE
+bytes with the byte class table. */
+static void classify_block_scalar(const unsigned char * block, size_t length, int flags, uint64_t * symbol_bits, uint64_t * word_bits) {
+
+	uint64_t symbols = 0;
+	uint64_t words = 0;
+
+	for(size_t i=0; i<length; i++) {
+
+		unsigned char byte_class = roman_byte_class[block[i]];
+
+		if((byte_class & ROMAN_CLASS_SYMBOL_MASK) && !((flags & ROMAN_SCAN_UPPERCASE_ONLY) && (block[i] & 0x20))) {
+			symbols |= (uint64_t)1 << i;
+		}
+
+		if(byte_class & ROMAN_CLASS_WORD) {
+			words |= (uint64_t)1 << i;
+		}
+	}
+
+	*symbol_bits = symbols;
+	*word_bits = words;
+}
+
+#ifdef __SSE2__
+
+/* Static helper function that classifies a block of exactly BLOCK_SIZE
+bytes, 16 at a time.  Letters are folded to lower case by setting bit
+0x20, which maps no other byte onto a lower case letter, so each symbol
+needs one comparison.  Unsigned range checks for letters and digits are
+done as signed comparisons after offsetting the range to start at
+-128.  Bytes of 0x80 and above are found from the sign bit alone. */
+static void classify_block_sse2(const unsigned char * block, int flags, uint64_t * symbol_bits, uint64_t * word_bits) {
+
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+	const char symbol_case = (flags & ROMAN_SCAN_UPPERCASE_ONLY) ? 0 : 0x20;
+
+	uint64_t symbols = 0;
+	uint64_t words = 0;
+
+	for(int part=0; part<BLOCK_SIZE/16; part++) {
+
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(block + 16 * part));
+		__m128i folded = _mm_or_si128(bytes, case_bit);
+		__m128i symbol_input = symbol_case ? folded : bytes;
+
+		__m128i symbol = _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('I' | symbol_case));
+		symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('V' | symbol_case)));
+		symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('X' | symbol_case)));
+		symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('L' | symbol_case)));
+		symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('C' | symbol_case)));
+		symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('D' | symbol_case)));
+		symbol = _mm_or_si128(symbol, _mm_cmpeq_epi8(symbol_input, _mm_set1_epi8('M' | symbol_case)));
+
+		__m128i letter = _mm_cmplt_epi8(_mm_add_epi8(folded, _mm_set1_epi8((char)(0x80 - 'a'))), _mm_set1_epi8((char)(0x80 + 26)));
+		__m128i digit = _mm_cmplt_epi8(_mm_add_epi8(bytes, _mm_set1_epi8((char)(0x80 - '0'))), _mm_set1_epi8((char)(0x80 + 10)));
+
+		uint64_t symbol_mask = (unsigned int)_mm_movemask_epi8(symbol);
+		uint64_t word_mask = (unsigned int)(_mm_movemask_epi8(_mm_or_si128(letter, digit)) | _mm_movemask_epi8(bytes));
+
+		symbols |= symbol_mask << (16 * part);
+		words |= word_mask << (16 * part);
+	}
+
+	*symbol_bits = symbols;
+	*word_bits = words;
+}
+
+#endif
+
+/* Static helper function that stores a match for roman_scan_array(),
+stopping the scan once the array is full. */
+static int store_match(size_t offset, size_t length, int decimal, void * context) {
+
+	scan_array_state * state = (scan_array_state*)context;
+
+	state->matches[state->count].offset = offset;
+	state->matches[state->count].length = length;
+	state->matches[state->count].decimal = decimal;
+	state->count++;
+
+	return state->count >= state->capacity;
+}
@@ -0,0 +1,255 @@
+/*
+roman_sequence.c
+
+This file defines the Roman numeral sequence generator.  A numeral is advanced to its successor by rewriting only its lowest decimal place, carrying into the higher places when that place holds a 9, in the same way a decimal number is incremented.  Whole sequences are written with the ones place taken from a table.
+
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_sequence.h"
+#include "roman_dfa.h"
+#include "roman_render.h"
+#include "roman_probes.h"
+
+/* Roman numeral symbols for 1, 5 and 10 in each decimal place, from the
+thousands down to the ones.  The thousands place only has a symbol for
+1, as the largest decimal number allowed is 3999. */
+static const char place_symbol[4][3] = {
+	{'M', '\0', '\0'},
+	{'C', 'D', 'M'},
+	{'X', 'L', 'C'},
+	{'I', 'V', 'X'}
+};
+
+/* Numeral of each digit written in terms of the symbols of its decimal
+place: 0 for the 1 symbol, 1 for the 5 symbol and 2 for the 10 symbol.
+Entries are terminated by -1. */
+static const signed char digit_pattern[10][5] = {
+	{-1},
+	{0, -1},
+	{0, 0, -1},
+	{0, 0, 0, -1},
+	{0, 1, -1},
+	{1, -1},
+	{1, 0, -1},
+	{1, 0, 0, -1},
+	{1, 0, 0, 0, -1},
+	{0, 2, -1}
+};
+
+/* Static helper function that checks "numeral" is a canonical, upper 
+case Roman numeral of exactly "length" symbols.  */
+static int check_numeral(const char * numeral, size_t length);
+
+/* Static helper function that increments a numeral in place, starting 
+at decimal place "lowest" (3 for the ones, 2 for the tens) and carrying 
+upwards.  Places below "lowest" must be empty.  */
+static int increment_place(char * numeral, size_t * length, int lowest);
+
+/* Static helper function that finds the digit held by the numeral of
+one decimal place, given that the place's numeral ends just before
+"end".  The start of the place's numeral is stored in "start". */
+static int read_digit(const char * numeral, size_t end, const char * symbol, size_t * start);
+
+/* Advance a Roman numeral to its successor in place.  See header file
+for full description. */
+int roman_next(char * numeral, size_t * length) {
+
+	ROMAN_PROBE2(roman_next__entry, numeral, length);
+
+	if(numeral == NULL || length == NULL || check_numeral(numeral, *length)) {
+
+		//Invalid input.  Only the last decimal places are read while
+		//advancing, so the whole numeral is validated first.
+		ROMAN_PROBE1(roman_next__return, 1);
+		return 1;
+	}
+
+	int failure_flag = increment_place(numeral, length, 3);
+
+	ROMAN_PROBE1(roman_next__return, failure_flag);
+	return failure_flag;
+}
+
+/* Write a sequence of Roman numerals.  See header file for full
+description. */
+int roman_range(const int start, const int count, char * out) {
+
+	ROMAN_PROBE3(roman_range__entry, start, count, out);
+
+	if(out == NULL || count < 0 || start < MIN_DECIMAL || start > MAX_DECIMAL || count > MAX_DECIMAL - start + 1) {
+
+		//Invalid input, or the sequence leaves the accepted range.
+		ROMAN_PROBE1(roman_range__return, 1);
+		return 1;
+	}
+
+	if(count == 0) {
+		ROMAN_PROBE1(roman_range__return, 0);
+		return 0;
+	}
+
+	/* The sequence is written ten numerals at a time.  "prefix" holds 
+	the numeral of the thousands, hundreds and tens places, which is 
+	shared by a run of ten numerals.  Each numeral is a 16 byte copy 
+	of the prefix followed by the ones place from the digit table.  The 
+	prefix is advanced with the same place increment as roman_next(), 
+	starting at the tens.  */
+	char prefix[ROMAN_NUMERAL_SIZE] = {'\0'};
+	size_t prefix_length = 0;
+	int ones = start % 10;
+
+	if(start >= 10) {
+
+		if(convert_decimal_to_roman(start - ones, prefix)) {
+			ROMAN_PROBE1(roman_range__return, 1);
+			return 1;
+		}
+
+		prefix_length = strlen(prefix);
+	}
+
+	char * numeral = out;
+
+	for(int i=0; i<count; i++) {
+
+		memcpy(numeral, prefix, ROMAN_NUMERAL_SIZE);
+		memcpy(numeral + prefix_length, roman_render_digit[3][ones], 4);
+		numeral[prefix_length + roman_render_length[ones]] = '\0';
+
+		numeral += ROMAN_NUMERAL_SIZE;
+
+		if(++ones == 10) {
+
+			ones = 0;
+
+			//Advancing past 3999 only happens after the last numeral.
+			if(i+1 < count) {
+				increment_place(prefix, &prefix_length, 2);
+			}
+		}
+	}
+
+	ROMAN_PROBE1(roman_range__return, 0);
+	return 0;
+}
+
+/* Static helper function that checks a numeral.  The validator reads 
+at most MAX_LENGTH_ROMAN plus one characters, so the string is known 
+to be terminated before its length is measured.  Lower case symbols, 
+which the validator accepts, are rejected here as the increment 
+writes upper case.  Returns '0' if the numeral is valid.  */
+static int check_numeral(const char * numeral, size_t length) {
+
+	if(length > strlen(MAX_LENGTH_ROMAN) || roman_dfa_parse(numeral) == 0 || strlen(numeral) != length) {
+		return 1;
+	}
+
+	for(size_t i=0; i<length; i++) {
+
+		if(numeral[i] >= 'a' && numeral[i] <= 'z') {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Static helper function that increments a numeral in place, carrying 
+upwards.  See declaration above.  */
+static int increment_place(char * numeral, size_t * length, int lowest) {
+
+	//End of the numeral of the decimal place being incremented.
+	//Lower places are always empty (0) by the time a higher place is
+	//reached.
+	size_t end = *length;
+
+	for(int place=lowest; place>=0; place--) {
+
+		const char * symbol = place_symbol[place];
+		size_t start;
+		int digit = read_digit(numeral, end, symbol, &start);
+
+		if(digit < 0) {
+
+			//Not a canonical numeral.
+			return 1;
+		}
+
+		//A 9 (or 3 in the thousands) becomes 0 and carries.
+		if(digit == 9 || (place == 0 && digit == 3)) {
+
+			end = start;
+			continue;
+		}
+
+		//The numeral with this place rewritten must still fit.
+		if(start + roman_render_length[digit+1] > strlen(MAX_LENGTH_ROMAN)) {
+			return 1;
+		}
+
+		//Rewrite this place with the next digit.
+		size_t write = start;
+		for(const signed char * pattern = digit_pattern[digit+1]; *pattern >= 0; pattern++) {
+			numeral[write++] = symbol[*pattern];
+		}
+
+		numeral[write] = '\0';
+		*length = write;
+
+		return 0;
+	}
+
+	//Carried out of the thousands, the numeral was already 3999.
+	return 1;
+}
+
+/* Static helper function that reads the digit of one decimal place
+backwards from "end".  The place's numeral is one of: 1 to 3 symbols
+for 1, the symbols for 1 and 5 (4), the symbol for 5 followed by 0 to
+3 symbols for 1 (5-8), or the symbols for 1 and 10 (9).  A numeral
+that ends with none of those symbols holds 0.  Returns -1 if the end
+of the numeral does not match any of the forms. */
+static int read_digit(const char * numeral, size_t end, const char * symbol, size_t * start) {
+
+	const char one = symbol[0];
+	const char five = symbol[1];
+	const char ten = symbol[2];
+
+	//9: the symbols for 1 and 10.
+	if(end >= 2 && ten != '\0' && numeral[end-1] == ten && numeral[end-2] == one) {
+
+		*start = end - 2;
+		return 9;
+	}
+
+	//4: the symbols for 1 and 5.
+	if(end >= 2 && five != '\0' && numeral[end-1] == five && numeral[end-2] == one) {
+
+		*start = end - 2;
+		return 4;
+	}
+
+	//Count the trailing symbols for 1.
+	int ones = 0;
+	while(ones < (int)end && numeral[end-1-ones] == one) {
+		ones++;
+	}
+
+	if(ones > 3) {
+		return -1;
+	}
+
+	//5-8: a leading symbol for 5.
+	if(five != '\0' && ones < (int)end && numeral[end-1-ones] == five) {
+
+		*start = end - 1 - ones;
+		return 5 + ones;
+	}
+
+	*start = end - ones;
+	return ones;
+}
@@ -0,0 +1,117 @@
+/*
+roman_stream.c
+
+This file defines the streaming Roman numeral parser.  Input arrives in arbitrary chunks, and tokens split across chunks are parsed incrementally, so each byte is read exactly once and nothing is buffered.
+
+*/
+
+#include <stddef.h>
+
+#include "roman_stream.h"
+#include "roman_dfa.h"
+#include "roman_probes.h"
+
+/* Static helper function that reports the open token and closes it. */
+static void emit_token(roman_stream * stream, roman_stream_callback callback, void * context);
+
+/* Initialise a streaming parser.  See header file for full description. */
+void roman_stream_init(roman_stream * stream) {
+
+	if(stream == NULL) {
+		return;
+	}
+
+	stream->offset = 0;
+	stream->token_offset = 0;
+	stream->token_value = 0;
+	stream->token_state = ROMAN_DFA_START;
+	stream->token_status = 0;
+	stream->in_token = 0;
+}
+
+/* Parse the next chunk of the stream.  See header file for full
+description. */
+int roman_stream_feed(roman_stream * stream, const char * chunk, size_t length, roman_stream_callback callback, void * context) {
+
+	ROMAN_PROBE3(roman_stream_feed__entry, stream, chunk, length);
+
+	if(stream == NULL || callback == NULL || (chunk == NULL && length > 0)) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_stream_feed__return, 1);
+		return 1;
+	}
+
+	for(size_t i=0; i<length; i++) {
+
+		unsigned char byte_class = roman_byte_class[(unsigned char)chunk[i]];
+
+		if(byte_class & ROMAN_CLASS_DELIMITER) {
+
+			//A delimiter completes the open token, if any.
+			if(stream->in_token) {
+				emit_token(stream, callback, context);
+			}
+			continue;
+		}
+
+		if(!stream->in_token) {
+
+			//First byte of a new token.
+			stream->in_token = 1;
+			stream->token_offset = stream->offset + i;
+			stream->token_value = 0;
+			stream->token_state = ROMAN_DFA_START;
+			stream->token_status = 0;
+		}
+
+		//Once a token is known to be invalid, its remaining bytes are
+		//only checked for the closing delimiter.
+		if(stream->token_status == 0) {
+
+			int symbol = (int)(byte_class & ROMAN_CLASS_SYMBOL_MASK) - 1;
+
+			if(symbol < 0 || roman_dfa_step(&stream->token_state, &stream->token_value, symbol)) {
+				stream->token_status = 1;
+			}
+		}
+	}
+
+	stream->offset += length;
+
+	ROMAN_PROBE1(roman_stream_feed__return, 0);
+	return 0;
+}
+
+/* Mark the end of the stream.  See header file for full description. */
+int roman_stream_finish(roman_stream * stream, roman_stream_callback callback, void * context) {
+
+	ROMAN_PROBE1(roman_stream_finish__entry, stream);
+
+	if(stream == NULL || callback == NULL) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_stream_finish__return, 1);
+		return 1;
+	}
+
+	if(stream->in_token) {
+		emit_token(stream, callback, context);
+	}
+
+	roman_stream_init(stream);
+
+	ROMAN_PROBE1(roman_stream_finish__return, 0);
+	return 0;
+}
+
+/* Static helper function that reports the open token and closes it.
+An invalid token is reported with a value of 0. */
+static void emit_token(roman_stream * stream, roman_stream_callback callback, void * context) {
+
+	int status = stream->token_status;
+
+	callback(status ? 0 : stream->token_value, stream->token_offset, status, context);
+
+	stream->in_token = 0;
+}
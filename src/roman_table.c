@@ -0,0 +1,333 @@
+/*
+roman_table.c
+
+This file defines the precomputed result table of the Roman numeral calculator library.  A table is a header and the numerals of 0-3999 in fixed-size entries, laid out identically in memory and in table files, so an opened file is used directly from its read-only mapping.
+
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "roman_numeral_calc.h"
+#include "roman_table.h"
+#include "roman_probes.h"
+
+//Number of entries, and the size of a table in bytes.
+#define TABLE_ENTRIES (MAX_DECIMAL + 1)
+#define TABLE_SIZE (sizeof(roman_table_header) + TABLE_ENTRIES * ROMAN_NUMERAL_SIZE)
+
+/* Table handle.  "entries" points just past the header of "base",
+which is either a read-only mapping of "size" bytes (if "mapped") or a
+heap allocation. */
+struct roman_table {
+	const char * base;
+	const char * entries;
+	size_t size;
+	int mapped;
+};
+
+/* Static helper function that generates a complete table (header and
+entries) into "buffer", which must hold TABLE_SIZE bytes. */
+static void generate_table(char * buffer);
+
+/* Static helper function that hashes the entries of a table. */
+static uint32_t checksum_entries(const char * entries);
+
+/* Static helper function that combines the operands of an addition or
+subtraction through the table. */
+static int lookup_result(const roman_table * table, const char * numeral_a, const char * numeral_b, const int subtract, char * numeral_result);
+
+/* Generate a table file.  See header file for full description. */
+int roman_table_write(const char * path) {
+
+	ROMAN_PROBE1(roman_table_write__entry, path);
+
+	if(path == NULL) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_table_write__return, 1);
+		return 1;
+	}
+
+	char * buffer = (char*)malloc(TABLE_SIZE);
+	char * temp_path = (char*)malloc(strlen(path) + 8);
+
+	if(buffer == NULL || temp_path == NULL) {
+
+		free(buffer);
+		free(temp_path);
+		ROMAN_PROBE1(roman_table_write__return, 1);
+		return 1;
+	}
+
+	generate_table(buffer);
+	strcpy(temp_path, path);
+	strcat(temp_path, ".XXXXXX");
+
+	//Every writer gets a temporary file of its own, so writers of the
+	//same table never write into each other's file.
+	int failure_flag = 1;
+	int fd = mkstemp(temp_path);
+
+	if(fd >= 0) {
+
+		//mkstemp() creates the file readable by its owner only, but
+		//the table is meant to be shared.
+		FILE * file = fchmod(fd, 0644) == 0 ? fdopen(fd, "wb") : NULL;
+
+		if(file == NULL) {
+
+			close(fd);
+			remove(temp_path);
+		}
+		else {
+
+			//The file must be completely written, and on disk, before
+			//it is renamed into place, so a crash never leaves a
+			//partial table at "path".
+			int written = fwrite(buffer, 1, TABLE_SIZE, file) == TABLE_SIZE
+				&& fflush(file) == 0
+				&& fsync(fileno(file)) == 0;
+
+			if(fclose(file) == 0 && written && rename(temp_path, path) == 0) {
+				failure_flag = 0;
+			}
+			else {
+				remove(temp_path);
+			}
+		}
+	}
+
+	free(buffer);
+	free(temp_path);
+
+	ROMAN_PROBE1(roman_table_write__return, failure_flag);
+	return failure_flag;
+}
+
+/* Map a table file.  See header file for full description. */
+roman_table * roman_table_open(const char * path) {
+
+	ROMAN_PROBE1(roman_table_open__entry, path);
+
+	if(path == NULL) {
+
+		//Invalid input.
+		ROMAN_PROBE1(roman_table_open__return, NULL);
+		return NULL;
+	}
+
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		ROMAN_PROBE1(roman_table_open__return, NULL);
+		return NULL;
+	}
+
+	struct stat file_stat;
+
+	if(fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size != TABLE_SIZE) {
+
+		//Not a table, or truncated.
+		close(fd);
+		ROMAN_PROBE1(roman_table_open__return, NULL);
+		return NULL;
+	}
+
+	void * base = mmap(NULL, TABLE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+
+	//The mapping stays valid after the descriptor is closed.
+	close(fd);
+
+	if(base == MAP_FAILED) {
+		ROMAN_PROBE1(roman_table_open__return, NULL);
+		return NULL;
+	}
+
+	const roman_table_header * header = (const roman_table_header*)base;
+	const char * entries = (const char*)base + sizeof(roman_table_header);
+
+	if(memcmp(header->magic, ROMAN_TABLE_MAGIC, sizeof(header->magic)) != 0
+		|| header->version != ROMAN_TABLE_VERSION
+		|| header->entry_size != ROMAN_NUMERAL_SIZE
+		|| header->entry_count != TABLE_ENTRIES
+		|| header->checksum != checksum_entries(entries)) {
+
+		//Not a table written by this version of the library, or
+		//corrupted.
+		munmap(base, TABLE_SIZE);
+		ROMAN_PROBE1(roman_table_open__return, NULL);
+		return NULL;
+	}
+
+	roman_table * table = (roman_table*)malloc(sizeof(roman_table));
+	if(table == NULL) {
+
+		munmap(base, TABLE_SIZE);
+		ROMAN_PROBE1(roman_table_open__return, NULL);
+		return NULL;
+	}
+
+	table->base = (const char*)base;
+	table->entries = entries;
+	table->size = TABLE_SIZE;
+	table->mapped = 1;
+
+	ROMAN_PROBE1(roman_table_open__return, table);
+	return table;
+}
+
+/* Build a table in memory.  See header file for full description. */
+roman_table * roman_table_build(void) {
+
+	ROMAN_PROBE0(roman_table_build__entry);
+
+	roman_table * table = (roman_table*)malloc(sizeof(roman_table));
+	char * buffer = (char*)malloc(TABLE_SIZE);
+
+	if(table == NULL || buffer == NULL) {
+
+		free(table);
+		free(buffer);
+		ROMAN_PROBE1(roman_table_build__return, NULL);
+		return NULL;
+	}
+
+	generate_table(buffer);
+
+	table->base = buffer;
+	table->entries = buffer + sizeof(roman_table_header);
+	table->size = TABLE_SIZE;
+	table->mapped = 0;
+
+	ROMAN_PROBE1(roman_table_build__return, table);
+	return table;
+}
+
+/* Release a table.  See header file for full description. */
+void roman_table_close(roman_table * table) {
+
+	if(table == NULL) {
+		return;
+	}
+
+	if(table->mapped) {
+		munmap((void*)table->base, table->size);
+	}
+	else {
+		free((void*)table->base);
+	}
+
+	free(table);
+}
+
+/* Returns the numeral of a decimal number.  See header file for full
+description. */
+const char * roman_table_numeral(const roman_table * table, const int decimal) {
+
+	if(table == NULL || decimal < MIN_DECIMAL || decimal > MAX_DECIMAL) {
+
+		//Invalid input.
+		return NULL;
+	}
+
+	return table->entries + (size_t)decimal * ROMAN_NUMERAL_SIZE;
+}
+
+/* Add two Roman numerals through the table.  See header file for full
+description. */
+int roman_table_addition(const roman_table * table, const char * numeral_a, const char * numeral_b, char * numeral_sum) {
+
+	ROMAN_PROBE3(roman_table_addition__entry, table, numeral_a, numeral_b);
+
+	int failure_flag = lookup_result(table, numeral_a, numeral_b, 0, numeral_sum);
+
+	ROMAN_PROBE1(roman_table_addition__return, failure_flag);
+	return failure_flag;
+}
+
+/* Subtract two Roman numerals through the table.  See header file for
+full description. */
+int roman_table_subtraction(const roman_table * table, const char * numeral_a, const char * numeral_b, char * numeral_diff) {
+
+	ROMAN_PROBE3(roman_table_subtraction__entry, table, numeral_a, numeral_b);
+
+	int failure_flag = lookup_result(table, numeral_a, numeral_b, 1, numeral_diff);
+
+	ROMAN_PROBE1(roman_table_subtraction__return, failure_flag);
+	return failure_flag;
+}
+
+/* Static helper function that generates a complete table.  Entries are
+zeroed first, so every numeral is padded with null characters. */
+static void generate_table(char * buffer) {
+
+	roman_table_header * header = (roman_table_header*)buffer;
+	char * entries = buffer + sizeof(roman_table_header);
+
+	memset(buffer, 0, TABLE_SIZE);
+
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(i, entries + (size_t)i * ROMAN_NUMERAL_SIZE);
+	}
+
+	memcpy(header->magic, ROMAN_TABLE_MAGIC, sizeof(header->magic));
+	header->version = ROMAN_TABLE_VERSION;
+	header->entry_size = ROMAN_NUMERAL_SIZE;
+	header->entry_count = TABLE_ENTRIES;
+	header->checksum = checksum_entries(entries);
+}
+
+/* Static helper function that hashes the entries (FNV-1a). */
+static uint32_t checksum_entries(const char * entries) {
+
+	uint32_t hash = 2166136261u;
+
+	for(size_t i=0; i<TABLE_ENTRIES * ROMAN_NUMERAL_SIZE; i++) {
+		hash = (hash ^ (unsigned char)entries[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+/* Static helper function that parses both operands, checks the result
+is in range and copies its entry. */
+static int lookup_result(const roman_table * table, const char * numeral_a, const char * numeral_b, const int subtract, char * numeral_result) {
+
+	if(table == NULL || numeral_a == NULL || numeral_b == NULL || numeral_result == NULL) {
+
+		//Invalid input.
+		return 1;
+	}
+
+	int decimal_a;
+	int decimal_b;
+
+	if(convert_roman_to_decimal(numeral_a, &decimal_a) || convert_roman_to_decimal(numeral_b, &decimal_b)) {
+
+		//Conversion failure.
+		return 1;
+	}
+
+	int decimal_result = subtract ? decimal_a - decimal_b : decimal_a + decimal_b;
+
+	if(decimal_result < MIN_DECIMAL || decimal_result > MAX_DECIMAL) {
+
+		//Invalid result.
+		return 1;
+	}
+
+	//Only the numeral and its null character are copied, so the result
+	//string needs no more room than with roman_addition().
+	const char * entry = table->entries + (size_t)decimal_result * ROMAN_NUMERAL_SIZE;
+	memcpy(numeral_result, entry, strlen(entry) + 1);
+
+	return 0;
+}
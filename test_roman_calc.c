@@ -13,10 +13,23 @@ This program uses the Check library, libcheck, to run a series of tests on the f
 #include <malloc.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdint.h>
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
 #include <check.h>
 
 #include "roman_numeral_calc.h"
+#include "roman_accumulator.h"
+#include "roman_stream.h"
+#include "roman_scan.h"
+#include "roman_sequence.h"
+#include "roman_intern.h"
+#include "roman_columns.h"
+#include "roman_arena.h"
+#include "roman_table.h"
+#include "roman_pipeline.h"
 
 //Test for the decimal to Roman numeral conversion function.  
 START_TEST(convert_decimal_to_roman_test) {
@@ -129,6 +142,31 @@ START_TEST(convert_decimal_to_roman_test) {
 	convert_decimal_to_roman(2900, numeral);
 	ck_assert_str_eq(numeral, "MMCM");
 
+	//Only the numeral and its null character are written, so a string 
+	//sized for the numeral is enough with every engine.  
+	char exact[sizeof("VIII") + 1];
+	memset(exact, '#', sizeof(exact));
+	convert_decimal_to_roman(8, exact);
+	ck_assert_str_eq(exact, "VIII");
+	ck_assert_int_eq(exact[sizeof("VIII")], '#');
+
+	//A slot holds the same numeral, padded with null characters.  
+	char slot[ROMAN_NUMERAL_SIZE];
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+
+		memset(slot, '#', sizeof(slot));
+		ck_assert_int_eq(convert_decimal_to_roman_slot(i, slot), 0);
+		convert_decimal_to_roman(i, numeral);
+		ck_assert_str_eq(slot, numeral);
+
+		for(size_t j=strlen(numeral); j<sizeof(slot); j++) {
+			ck_assert_int_eq(slot[j], '\0');
+		}
+	}
+
+	ck_assert_int_eq(convert_decimal_to_roman_slot(0, slot), 1);
+	ck_assert_int_eq(convert_decimal_to_roman_slot(1, NULL), 1);
+
 	//Free memory assigned to "numeral" string.
 	free(numeral);
 }
@@ -397,6 +435,994 @@ START_TEST(roman_subtraction_test) {
 }
 END_TEST
 
+/* Test the running total accumulator.  Numerals and decimal numbers 
+are added and subtracted, the total and its cached rendering are 
+checked, and operations that would leave the 1-3999 range must fail 
+without changing the total.  */
+START_TEST(roman_accumulator_test) {
+
+	roman_accumulator * accumulator = allocate_roman_accumulator();
+	ck_assert(accumulator != NULL);
+
+	//Flag to check for failure conditions
+	int failure_flag = 0;
+
+	//A new accumulator totals zero, which has no numeral.  
+	ck_assert_int_eq(roman_accumulator_decimal(accumulator), 0);
+	ck_assert(roman_accumulator_numeral(accumulator) == NULL);
+
+	//Subtracting from zero fails.  
+	failure_flag = roman_accumulator_subtract_decimal(accumulator, 1);
+	ck_assert_int_eq(failure_flag, 1);
+
+	//Add numerals and decimal numbers.  
+	failure_flag = roman_accumulator_add_numeral(accumulator, "MCM");
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_str_eq(roman_accumulator_numeral(accumulator), "MCM");
+
+	failure_flag = roman_accumulator_add_decimal(accumulator, 84);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_int_eq(roman_accumulator_decimal(accumulator), 1984);
+
+	//The rendering is cached, the same string is returned until the 
+	//total changes.  
+	const char * numeral = roman_accumulator_numeral(accumulator);
+	ck_assert_str_eq(numeral, "MCMLXXXIV");
+	ck_assert(roman_accumulator_numeral(accumulator) == numeral);
+
+	failure_flag = roman_accumulator_subtract_numeral(accumulator, "lxxxiv");
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_str_eq(roman_accumulator_numeral(accumulator), "MCM");
+
+	//Invalid operands and out of range totals fail, leaving the 
+	//total unchanged.  
+	failure_flag = roman_accumulator_add_numeral(accumulator, "IIII");
+	ck_assert_int_eq(failure_flag, 1);
+
+	failure_flag = roman_accumulator_add_numeral(accumulator, NULL);
+	ck_assert_int_eq(failure_flag, 1);
+
+	failure_flag = roman_accumulator_add_decimal(accumulator, 0);
+	ck_assert_int_eq(failure_flag, 1);
+
+	failure_flag = roman_accumulator_add_numeral(accumulator, "MMC");
+	ck_assert_int_eq(failure_flag, 1);
+
+	failure_flag = roman_accumulator_subtract_decimal(accumulator, 1900);
+	ck_assert_int_eq(failure_flag, 1);
+
+	ck_assert_int_eq(roman_accumulator_decimal(accumulator), 1900);
+
+	//Add up to the largest total allowed.  
+	failure_flag = roman_accumulator_add_numeral(accumulator, "MMXCIX");
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_str_eq(roman_accumulator_numeral(accumulator), MAX_VALUE_ROMAN);
+
+	//Reset returns the total to zero.  
+	roman_accumulator_reset(accumulator);
+	ck_assert_int_eq(roman_accumulator_decimal(accumulator), 0);
+	ck_assert(roman_accumulator_numeral(accumulator) == NULL);
+
+	free_roman_accumulator(accumulator);
+}
+END_TEST
+
+//Tokens collected from the streaming parser by collect_stream_token().
+typedef struct {
+	int count;
+	int decimal[32];
+	int status[32];
+	unsigned long long offset[32];
+} stream_tokens;
+
+/* Callback for the streaming parser test, records every token.  */
+static void collect_stream_token(int decimal, unsigned long long offset, int status, void * context) {
+
+	stream_tokens * tokens = (stream_tokens*)context;
+
+	if(tokens->count < 32) {
+		tokens->decimal[tokens->count] = decimal;
+		tokens->status[tokens->count] = status;
+		tokens->offset[tokens->count] = offset;
+	}
+	tokens->count++;
+}
+
+/* Test the streaming parser.  Every Roman numeral 1-3999 must parse 
+to its value, a stream of mixed tokens must give the same tokens no 
+matter where it is split into chunks, and invalid tokens must be 
+reported with a failure status.  */
+START_TEST(roman_stream_test) {
+
+	roman_stream stream;
+	stream_tokens tokens;
+	char * numeral = allocate_roman_numeral_string();
+
+	//Every valid numeral, fed as a single token.  
+	for(int i=1; i <= MAX_DECIMAL; i++) {
+
+		convert_decimal_to_roman(i, numeral);
+
+		memset(&tokens, 0, sizeof(tokens));
+		roman_stream_init(&stream);
+		roman_stream_feed(&stream, numeral, strlen(numeral), collect_stream_token, &tokens);
+		roman_stream_finish(&stream, collect_stream_token, &tokens);
+
+		ck_assert_int_eq(tokens.count, 1);
+		ck_assert_msg(tokens.status[0] == 0, "Failed to parse %s (%i).", numeral, i);
+		ck_assert_int_eq(tokens.decimal[0], i);
+	}
+
+	free(numeral);
+
+	//Mixed valid and invalid tokens.  
+	const char input[] = "MMDCCCLXX iv,IIII; XM\tx1  mmmcmxcix\nVIV IL MMMM abc";
+	const int expected_decimal[] = {2870, 4, 0, 0, 0, 3999, 0, 0, 0, 0};
+	const int expected_status[] = {0, 0, 1, 1, 1, 0, 1, 1, 1, 1};
+	const unsigned long long expected_offset[] = {0, 10, 13, 19, 22, 26, 36, 40, 43, 48};
+	const size_t input_length = strlen(input);
+
+	//Split the stream into two chunks at every position.  
+	for(size_t split=0; split <= input_length; split++) {
+
+		memset(&tokens, 0, sizeof(tokens));
+		roman_stream_init(&stream);
+
+		ck_assert_int_eq(roman_stream_feed(&stream, input, split, collect_stream_token, &tokens), 0);
+		ck_assert_int_eq(roman_stream_feed(&stream, input + split, input_length - split, collect_stream_token, &tokens), 0);
+		ck_assert_int_eq(roman_stream_finish(&stream, collect_stream_token, &tokens), 0);
+
+		ck_assert_int_eq(tokens.count, 10);
+
+		for(int t=0; t<10; t++) {
+			ck_assert_msg(tokens.decimal[t] == expected_decimal[t] && tokens.status[t] == expected_status[t] 
+				&& tokens.offset[t] == expected_offset[t], "Token %i wrong when split at %i.", t, (int)split);
+		}
+	}
+
+	//Feed the stream one byte at a time.  
+	memset(&tokens, 0, sizeof(tokens));
+	roman_stream_init(&stream);
+
+	for(size_t i=0; i<input_length; i++) {
+		roman_stream_feed(&stream, input + i, 1, collect_stream_token, &tokens);
+	}
+	roman_stream_finish(&stream, collect_stream_token, &tokens);
+
+	ck_assert_int_eq(tokens.count, 10);
+	ck_assert_int_eq(tokens.decimal[5], 3999);
+	ck_assert_int_eq(tokens.offset[9], 48);
+
+	//Invalid arguments.  
+	ck_assert_int_eq(roman_stream_feed(NULL, input, 1, collect_stream_token, &tokens), 1);
+	ck_assert_int_eq(roman_stream_feed(&stream, NULL, 1, collect_stream_token, &tokens), 1);
+	ck_assert_int_eq(roman_stream_feed(&stream, input, 1, NULL, &tokens), 1);
+	ck_assert_int_eq(roman_stream_finish(&stream, NULL, &tokens), 1);
+}
+END_TEST
+
+/* Test the text scanner.  A short text checks the word boundary 
+rules and flags, then a long random text is scanned and compared with 
+a simple reference scan that splits the text into words and checks 
+each word with the conversion functions.  */
+START_TEST(roman_scan_test) {
+
+	roman_scan_match matches[2048];
+	size_t count = 0;
+	int failure_flag = 0;
+
+	//Numerals must be whole words and valid.  "MIXED", "IIII", 
+	//"X2" and "MÉ" are not numerals.  
+	const char text[] = "Chapter XIV, part iv: MIXED IIII X2 (MCMLXXXIV) M\xc3\x89 Mix done.";
+
+	failure_flag = roman_scan_array(text, strlen(text), ROMAN_SCAN_DEFAULT, matches, 2048, &count);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_int_eq(count, 4);
+	ck_assert_int_eq(matches[0].offset, 8);
+	ck_assert_int_eq(matches[0].length, 3);
+	ck_assert_int_eq(matches[0].decimal, 14);
+	ck_assert_int_eq(matches[1].decimal, 4);
+	ck_assert_int_eq(matches[2].offset, 37);
+	ck_assert_int_eq(matches[2].decimal, 1984);
+	ck_assert_int_eq(matches[3].decimal, 1009);
+
+	//Upper case only skips "iv" and "Mix".  
+	failure_flag = roman_scan_array(text, strlen(text), ROMAN_SCAN_UPPERCASE_ONLY, matches, 2048, &count);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_int_eq(count, 2);
+	ck_assert_int_eq(matches[1].decimal, 1984);
+
+	//Scanning stops when the array is full.  
+	roman_scan_array(text, strlen(text), ROMAN_SCAN_DEFAULT, matches, 1, &count);
+	ck_assert_int_eq(count, 1);
+
+	//Invalid arguments.  
+	ck_assert_int_eq(roman_scan(text, 1, ROMAN_SCAN_DEFAULT, NULL, NULL), 1);
+	ck_assert_int_eq(roman_scan_array(NULL, 1, ROMAN_SCAN_DEFAULT, matches, 2048, &count), 1);
+
+	//Random text from an alphabet heavy in numeral symbols, long 
+	//enough to cover many blocks and numerals that cross them.  
+	const char alphabet[] = "MDCLXVImdclxvi  ab,.1\n\x80";
+	const int text_length = 20000;
+	char * random_text = malloc(text_length);
+
+	srand(42);
+	for(int i=0; i<text_length; i++) {
+		random_text[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+	}
+
+	roman_scan_array(random_text, text_length, ROMAN_SCAN_DEFAULT, matches, 2048, &count);
+	ck_assert(count > 0 && count < 2048);
+
+	//Reference scan, word by word.  
+	size_t expected = 0;
+	char word[32];
+	char * numeral = allocate_roman_numeral_string();
+
+	for(int i=0; i<text_length; ) {
+
+		if(!isalnum((unsigned char)random_text[i]) && !(random_text[i] & 0x80)) {
+			i++;
+			continue;
+		}
+
+		int start = i;
+		while(i < text_length && (isalnum((unsigned char)random_text[i]) || (random_text[i] & 0x80))) {
+			i++;
+		}
+
+		//A word is a numeral if it converts to decimal and back to 
+		//the same symbols.  
+		int decimal = 0;
+		int length = i - start;
+		if(length >= (int)sizeof(word)) {
+			continue;
+		}
+
+		memcpy(word, random_text + start, length);
+		word[length] = '\0';
+
+		if(convert_roman_to_decimal(word, &decimal) == 0 && decimal > 0 && convert_decimal_to_roman(decimal, numeral) == 0 
+			&& strlen(numeral) == (size_t)length) {
+
+			for(int k=0; k<length; k++) {
+				numeral[k] = tolower(numeral[k]);
+				word[k] = tolower(word[k]);
+			}
+
+			if(strcmp(numeral, word) == 0) {
+				ck_assert_msg(expected < count && matches[expected].offset == (size_t)start 
+					&& matches[expected].decimal == decimal, "Missed numeral %s at %i.", word, start);
+				expected++;
+			}
+		}
+	}
+
+	ck_assert_int_eq(expected, count);
+
+	free(numeral);
+	free(random_text);
+}
+END_TEST
+
+/* Test the sequence generator.  Advancing "I" with roman_next() must 
+step through every numeral produced by convert_decimal_to_roman(), and 
+roman_range() must write the same numerals.  */
+START_TEST(roman_sequence_test) {
+
+	char * expected = allocate_roman_numeral_string();
+	char * numeral = allocate_roman_numeral_string();
+	size_t length = 1;
+	int failure_flag = 0;
+
+	strcpy(numeral, "I");
+
+	for(int i=2; i <= MAX_DECIMAL; i++) {
+
+		failure_flag = roman_next(numeral, &length);
+		ck_assert_int_eq(failure_flag, 0);
+
+		convert_decimal_to_roman(i, expected);
+		ck_assert_str_eq(numeral, expected);
+		ck_assert_int_eq(length, strlen(expected));
+	}
+
+	//3999 has no successor.  
+	failure_flag = roman_next(numeral, &length);
+	ck_assert_int_eq(failure_flag, 1);
+	ck_assert_str_eq(numeral, MAX_VALUE_ROMAN);
+
+	failure_flag = roman_next(NULL, &length);
+	ck_assert_int_eq(failure_flag, 1);
+
+	//Non-canonical numerals, values above MAX_DECIMAL, numerals of 15 
+	//symbols that are not valid, wrong lengths and lower case are all 
+	//rejected and left unchanged.  
+	static const char * invalid[] = {"IIV", "IIII", "VX", "MMMM", "MMMMM", "XXXXXXXXXXXXXXX", "MMMDCCCLXXXVIIII", "viii"};
+
+	for(size_t i=0; i<sizeof(invalid) / sizeof(invalid[0]); i++) {
+
+		memset(numeral, '#', ROMAN_NUMERAL_SIZE);
+		memcpy(numeral, invalid[i], strlen(invalid[i]) + 1);
+		length = strlen(invalid[i]);
+
+		failure_flag = roman_next(numeral, &length);
+		ck_assert_msg(failure_flag == 1, "%s was advanced.", invalid[i]);
+		ck_assert_str_eq(numeral, invalid[i]);
+		ck_assert_int_eq(length, strlen(invalid[i]));
+	}
+
+	strcpy(numeral, "VIII");
+	length = 3;
+	failure_flag = roman_next(numeral, &length);
+	ck_assert_int_eq(failure_flag, 1);
+
+	//The longest numeral, 15 symbols, advances to a shorter one.  
+	strcpy(numeral, MAX_LENGTH_ROMAN);
+	length = strlen(MAX_LENGTH_ROMAN);
+	failure_flag = roman_next(numeral, &length);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_str_eq(numeral, "MMMDCCCLXXXIX");
+	ck_assert_int_eq(length, 13);
+
+	//The whole range at once.  
+	char * range = malloc(MAX_DECIMAL * ROMAN_NUMERAL_SIZE);
+
+	failure_flag = roman_range(1, MAX_DECIMAL, range);
+	ck_assert_int_eq(failure_flag, 0);
+
+	for(int i=1; i <= MAX_DECIMAL; i++) {
+
+		convert_decimal_to_roman(i, expected);
+		ck_assert_str_eq(range + (i-1) * ROMAN_NUMERAL_SIZE, expected);
+	}
+
+	//A range starting part way, and ranges leaving 1-3999.  
+	failure_flag = roman_range(1998, 3, range);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_str_eq(range + 2 * ROMAN_NUMERAL_SIZE, "MM");
+
+	failure_flag = roman_range(3990, 11, range);
+	ck_assert_int_eq(failure_flag, 1);
+
+	failure_flag = roman_range(0, 1, range);
+	ck_assert_int_eq(failure_flag, 1);
+
+	free(range);
+	free(numeral);
+	free(expected);
+}
+END_TEST
+
+//Column and table shared by the threads of the interning test.
+#define INTERN_TEST_ROWS 4000
+#define INTERN_TEST_THREADS 4
+static const char * intern_test_column[INTERN_TEST_ROWS];
+static roman_intern * intern_test_table;
+
+/* Thread body for the interning test, encodes the shared column.  */
+static void * intern_test_thread(void * ids) {
+
+	roman_intern_encode(intern_test_table, intern_test_column, INTERN_TEST_ROWS, (uint16_t*)ids);
+	return NULL;
+}
+
+/* Test the interning table.  Strings are interned and looked up, a 
+column is dictionary-encoded, the cached values are used through ids, 
+and several threads encode the same column at once, which must give 
+every thread the same ids.  */
+START_TEST(roman_intern_test) {
+
+	roman_intern * table = allocate_roman_intern(16);
+	ck_assert(table != NULL);
+
+	uint16_t id = 0;
+	uint16_t id_upper = 0;
+	int failure_flag = 0;
+	int decimal = 0;
+	int result = 0;
+
+	ck_assert(allocate_roman_intern(0) == NULL);
+	ck_assert(allocate_roman_intern(ROMAN_INTERN_MAX_ENTRIES + 1) == NULL);
+
+	//Ids are given in order, keyed on the exact bytes.  
+	failure_flag = roman_intern_insert(table, "iv", &id);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_int_eq(id, 0);
+
+	roman_intern_insert(table, "IV", &id_upper);
+	ck_assert_int_eq(id_upper, 1);
+
+	roman_intern_insert(table, "iv", &id);
+	ck_assert_int_eq(id, 0);
+	ck_assert_int_eq(roman_intern_count(table), 2);
+
+	//Cached values.  
+	ck_assert_str_eq(roman_intern_string(table, 0), "iv");
+	ck_assert_str_eq(roman_intern_numeral(table, 0), "IV");
+	roman_intern_decimal(table, 0, &decimal);
+	ck_assert_int_eq(decimal, 4);
+
+	roman_intern_compare(table, 0, 1, &result);
+	ck_assert_int_eq(result, 0);
+
+	//Lookups without inserting.  
+	ck_assert_int_eq(roman_intern_find(table, "IV", &id), 0);
+	ck_assert_int_eq(id, 1);
+	ck_assert_int_eq(roman_intern_find(table, "V", &id), 1);
+
+	//Dictionary-encode a column.  Invalid numerals are interned and 
+	//cached as invalid; NULL and overlong strings are not interned.  
+	const char * column[] = {"MCM", "iv", "IIII", NULL, "MMMMMMMMMMMMMMMMMMMM", "X", "MCM"};
+	uint16_t ids[7];
+
+	failure_flag = roman_intern_encode(table, column, 7, ids);
+	ck_assert_int_eq(failure_flag, 1);
+	ck_assert_int_eq(ids[0], 2);
+	ck_assert_int_eq(ids[1], 0);
+	ck_assert_int_eq(ids[2], 3);
+	ck_assert_int_eq(ids[3], ROMAN_INTERN_INVALID_ID);
+	ck_assert_int_eq(ids[4], ROMAN_INTERN_INVALID_ID);
+	ck_assert_int_eq(ids[5], 4);
+	ck_assert_int_eq(ids[6], 2);
+	ck_assert_int_eq(roman_intern_count(table), 5);
+
+	ck_assert_int_eq(roman_intern_decimal(table, ids[2], &decimal), 1);
+	ck_assert(roman_intern_numeral(table, ids[2]) == NULL);
+	ck_assert(roman_intern_string(table, ROMAN_INTERN_INVALID_ID) == NULL);
+
+	//Operations on ids.  
+	long long sum = 0;
+	const uint16_t sum_ids[] = {ids[0], ids[1], ids[5], ids[6]};
+	failure_flag = roman_intern_sum(table, sum_ids, 4, &sum);
+	ck_assert_int_eq(failure_flag, 0);
+	ck_assert_int_eq(sum, 1900 + 4 + 10 + 1900);
+
+	failure_flag = roman_intern_sum(table, ids, 3, &sum);
+	ck_assert_int_eq(failure_flag, 1);
+
+	roman_intern_compare(table, ids[5], ids[0], &result);
+	ck_assert_int_eq(result, -1);
+
+	//The table holds at most its capacity.  
+	char string[8];
+	for(int i=1; i<=20; i++) {
+		snprintf(string, sizeof(string), "%d", i);
+		failure_flag = roman_intern_insert(table, string, &id);
+	}
+	ck_assert_int_eq(failure_flag, 1);
+	ck_assert_int_eq(roman_intern_count(table), 16);
+
+	free_roman_intern(table);
+
+	//Several threads encoding the same column at once.  
+	char (*numerals)[ROMAN_NUMERAL_SIZE] = calloc(INTERN_TEST_ROWS, ROMAN_NUMERAL_SIZE);
+	for(int i=0; i<INTERN_TEST_ROWS; i++) {
+		convert_decimal_to_roman((i * 7919) % 500 + 1, numerals[i]);
+		intern_test_column[i] = numerals[i];
+	}
+
+	intern_test_table = allocate_roman_intern(500);
+	uint16_t (*thread_ids)[INTERN_TEST_ROWS] = malloc(sizeof(uint16_t) * INTERN_TEST_ROWS * INTERN_TEST_THREADS);
+	pthread_t threads[INTERN_TEST_THREADS];
+
+	for(int t=0; t<INTERN_TEST_THREADS; t++) {
+		pthread_create(&threads[t], NULL, intern_test_thread, thread_ids[t]);
+	}
+	for(int t=0; t<INTERN_TEST_THREADS; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	ck_assert_int_eq(roman_intern_count(intern_test_table), 500);
+
+	for(int i=0; i<INTERN_TEST_ROWS; i++) {
+		for(int t=1; t<INTERN_TEST_THREADS; t++) {
+			ck_assert_int_eq(thread_ids[t][i], thread_ids[0][i]);
+		}
+		roman_intern_decimal(intern_test_table, thread_ids[0][i], &decimal);
+		ck_assert_int_eq(decimal, (i * 7919) % 500 + 1);
+	}
+
+	free_roman_intern(intern_test_table);
+	free(thread_ids);
+	free(numerals);
+}
+END_TEST
+
+/* Test the column-wise arithmetic.  Columns of random numerals, with 
+some invalid operands mixed in, are added and subtracted, and every 
+row is compared with roman_addition() and roman_subtraction().  */
+START_TEST(roman_columns_test) {
+
+	const size_t rows = 1000;
+	const char * invalid[] = {"IIII", "abc", NULL, "MMMMMMMMMMMMMMMMMMMMMMMM", "IVI"};
+
+	char (*numerals)[ROMAN_NUMERAL_SIZE] = calloc(2 * rows, ROMAN_NUMERAL_SIZE);
+	const char ** column_a = malloc(rows * sizeof(char *));
+	const char ** column_b = malloc(rows * sizeof(char *));
+	uint8_t validity[(1000 + 7) / 8];
+	int * decimal = malloc(rows * sizeof(int));
+	char * results = malloc(rows * ROMAN_NUMERAL_SIZE);
+	char * expected = allocate_roman_numeral_string();
+
+	srand(7);
+
+	for(size_t i=0; i<rows; i++) {
+
+		convert_decimal_to_roman(rand() % MAX_DECIMAL + 1, numerals[2*i]);
+		convert_decimal_to_roman(rand() % MAX_DECIMAL + 1, numerals[2*i+1]);
+
+		column_a[i] = (i % 17 == 3) ? invalid[i % 5] : numerals[2*i];
+		column_b[i] = (i % 23 == 5) ? invalid[i % 5] : numerals[2*i+1];
+	}
+
+	for(int subtract=0; subtract<2; subtract++) {
+
+		int failure_flag;
+
+		if(subtract) {
+			failure_flag = roman_sub_columns(column_a, column_b, rows, validity, decimal, results);
+		}
+		else {
+			failure_flag = roman_add_columns(column_a, column_b, rows, validity, decimal, results);
+		}
+
+		//Some rows are invalid.  
+		ck_assert_int_eq(failure_flag, 1);
+
+		for(size_t i=0; i<rows; i++) {
+
+			int valid = (validity[i / 8] >> (i % 8)) & 1;
+			int expected_failure;
+
+			if(column_a[i] == NULL || column_b[i] == NULL) {
+				expected_failure = 1;
+			}
+			else if(subtract) {
+				expected_failure = roman_subtraction(column_a[i], column_b[i], expected);
+			}
+			else {
+				expected_failure = roman_addition(column_a[i], column_b[i], expected);
+			}
+
+			ck_assert_msg(valid == !expected_failure, "Row %i validity wrong.", (int)i);
+
+			if(valid) {
+				ck_assert_str_eq(results + i * ROMAN_NUMERAL_SIZE, expected);
+				convert_roman_to_decimal(expected, &failure_flag);
+				ck_assert_int_eq(decimal[i], failure_flag);
+			}
+			else {
+				ck_assert_int_eq(decimal[i], 0);
+				ck_assert_str_eq(results + i * ROMAN_NUMERAL_SIZE, "");
+			}
+		}
+	}
+
+	//Decimal results only, on rows that are all valid.  
+	column_a[0] = "MM";
+	column_b[0] = "MCMXCIX";
+	column_a[1] = "i";
+	column_b[1] = "I";
+
+	ck_assert_int_eq(roman_add_columns(column_a, column_b, 2, validity, decimal, NULL), 0);
+	ck_assert_int_eq(validity[0], 3);
+	ck_assert_int_eq(decimal[0], 3999);
+	ck_assert_int_eq(decimal[1], 2);
+
+	//A difference below 1 is invalid.  
+	ck_assert_int_eq(roman_sub_columns(column_a + 1, column_b + 1, 1, validity, NULL, NULL), 1);
+	ck_assert_int_eq(validity[0], 0);
+
+	ck_assert_int_eq(roman_add_columns(NULL, column_b, 2, validity, decimal, NULL), 1);
+
+	free(expected);
+	free(results);
+	free(decimal);
+	free(column_b);
+	free(column_a);
+	free(numerals);
+}
+END_TEST
+
+//Test the rejection of oversized and malformed input.  
+START_TEST(roman_bounded_input_test) {
+
+	int decimal = 0;
+
+	//The longest numeral is accepted, one more symbol is not.  
+	ck_assert_int_eq(convert_roman_to_decimal(MAX_LENGTH_ROMAN, &decimal), 0);
+	ck_assert_int_eq(decimal, 3888);
+	ck_assert_int_eq(convert_roman_to_decimal(MAX_LENGTH_ROMAN "I", &decimal), 1);
+
+	//Empty strings and trailing symbols are not numerals.  
+	ck_assert_int_eq(convert_roman_to_decimal("", &decimal), 1);
+	ck_assert_int_eq(convert_roman_to_decimal("XM", &decimal), 1);
+	ck_assert_int_eq(convert_roman_to_decimal("VIV", &decimal), 1);
+	ck_assert_int_eq(convert_roman_to_decimal("MMMM", &decimal), 1);
+
+	//Lowercase numerals are accepted.  
+	ck_assert_int_eq(convert_roman_to_decimal("mcmxcix", &decimal), 0);
+	ck_assert_int_eq(decimal, 1999);
+
+	//A string without a null terminator is rejected from its first 
+	//16 characters, without reading past them.  
+	char * unterminated = malloc(ROMAN_NUMERAL_SIZE);
+	memcpy(unterminated, MAX_LENGTH_ROMAN "I", ROMAN_NUMERAL_SIZE);
+	ck_assert_int_eq(convert_roman_to_decimal(unterminated, &decimal), 1);
+
+	char * numeral = allocate_roman_numeral_string();
+	ck_assert_int_eq(roman_addition(unterminated, "I", numeral), 1);
+	ck_assert_int_eq(roman_subtraction("I", unterminated, numeral), 1);
+	free(unterminated);
+
+	//Huge strings of repeated symbols and a long valid prefix.  
+	const size_t huge_length = 1 << 20;
+	char * huge = malloc(huge_length + 1);
+
+	memset(huge, 'M', huge_length);
+	huge[huge_length] = '\0';
+	ck_assert_int_eq(convert_roman_to_decimal(huge, &decimal), 1);
+
+	memcpy(huge, "MMMCMXCIX", 9);
+	memset(huge + 9, 'I', huge_length - 9);
+	ck_assert_int_eq(convert_roman_to_decimal(huge, &decimal), 1);
+	free(huge);
+
+	//The output string need not be initialised.  
+	memset(numeral, 'X', ROMAN_NUMERAL_SIZE);
+	ck_assert_int_eq(convert_decimal_to_roman(14, numeral), 0);
+	ck_assert_str_eq(numeral, "XIV");
+	free(numeral);
+}
+END_TEST
+
+//Test Roman to decimal conversion against every string of up to 6 
+//Roman numeral symbols.  A string must convert if and only if it is 
+//the numeral of its value.  
+START_TEST(exhaustive_parse_test) {
+
+	static const char symbols[] = "MDCLXVI";
+	const int max_length = 6;
+
+	char * numeral = allocate_roman_numeral_string();
+	char string[8];
+	int accepted = 0;
+	int expected = 0;
+
+	//Count the numerals short enough to be generated below.  
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+		convert_decimal_to_roman(i, numeral);
+		expected += strlen(numeral) <= (size_t)max_length;
+	}
+
+	for(int length=1; length<=max_length; length++) {
+
+		int total = 1;
+		for(int i=0; i<length; i++) {
+			total *= 7;
+		}
+
+		for(int index=0; index<total; index++) {
+
+			//Spell out "index" in base 7 with the symbols.  
+			int rest = index;
+			for(int i=length-1; i>=0; i--) {
+				string[i] = symbols[rest % 7];
+				rest /= 7;
+			}
+			string[length] = '\0';
+
+			int decimal = 0;
+			if(convert_roman_to_decimal(string, &decimal) == 0) {
+
+				convert_decimal_to_roman(decimal, numeral);
+				ck_assert_msg(strcmp(numeral, string) == 0, "%s accepted as %i.", string, decimal);
+				accepted++;
+			}
+		}
+	}
+
+	ck_assert_int_eq(accepted, expected);
+	free(numeral);
+}
+END_TEST
+
+//Thread function for the arena test: checks the thread gets the same 
+//arena on every call, and returns it.  
+static void * arena_thread(void * arg) {
+
+	roman_arena * arena = roman_thread_arena();
+
+	if(arena != roman_thread_arena() || roman_arena_decimal_to_roman(arena, 7) == NULL) {
+		return NULL;
+	}
+
+	return arena;
+}
+
+//Test the numeral buffer arena.  
+START_TEST(roman_arena_test) {
+
+	ck_assert_ptr_eq(allocate_roman_arena(0), NULL);
+
+	roman_arena * arena = allocate_roman_arena(8);
+	ck_assert_ptr_ne(arena, NULL);
+	ck_assert_int_eq(roman_arena_capacity(arena), 8);
+
+	//Results are written to consecutive buffers.  
+	const char * numeral = roman_arena_decimal_to_roman(arena, 1994);
+	ck_assert_str_eq(numeral, "MCMXCIV");
+	ck_assert_str_eq(roman_arena_addition(arena, "XIV", "LX"), "LXXIV");
+	ck_assert_str_eq(roman_arena_subtraction(arena, "MMMCMXCIX", "I"), "MMMCMXCVIII");
+	ck_assert_int_eq(roman_arena_used(arena), 3);
+
+	//Failed operations do not use up a buffer.  
+	ck_assert_ptr_eq(roman_arena_decimal_to_roman(arena, 4000), NULL);
+	ck_assert_ptr_eq(roman_arena_addition(arena, "MMM", "M"), NULL);
+	ck_assert_ptr_eq(roman_arena_subtraction(arena, "I", "abc"), NULL);
+	ck_assert_int_eq(roman_arena_used(arena), 3);
+
+	//Buffers can be the output of any function.  
+	char * sum = roman_arena_numeral(arena);
+	ck_assert_str_eq(sum, "");
+	ck_assert_int_eq(roman_addition("CC", "II", sum), 0);
+	ck_assert_str_eq(sum, "CCII");
+	ck_assert_str_eq(numeral, "MCMXCIV");
+
+	//Bulk buffers, for the functions that write many numerals.  
+	ck_assert_ptr_eq(roman_arena_numerals(arena, 5), NULL);
+	char * range = roman_arena_numerals(arena, 4);
+	ck_assert_int_eq(roman_range(8, 4, range), 0);
+	ck_assert_str_eq(range + 3 * ROMAN_NUMERAL_SIZE, "XI");
+
+	//The arena is now full.  
+	ck_assert_ptr_eq(roman_arena_numeral(arena), NULL);
+	ck_assert_ptr_eq(roman_arena_decimal_to_roman(arena, 1), NULL);
+
+	//A reset releases every buffer at once.  
+	roman_arena_reset(arena);
+	ck_assert_int_eq(roman_arena_used(arena), 0);
+	ck_assert_ptr_eq(roman_arena_numerals(arena, 8), range - 4 * ROMAN_NUMERAL_SIZE);
+
+	free_roman_arena(arena);
+	free_roman_arena(NULL);
+
+	//Every thread has its own arena.  
+	pthread_t threads[4];
+	void * arenas[4];
+
+	for(int i=0; i<4; i++) {
+		pthread_create(&threads[i], NULL, arena_thread, NULL);
+	}
+
+	for(int i=0; i<4; i++) {
+		pthread_join(threads[i], &arenas[i]);
+		ck_assert_ptr_ne(arenas[i], NULL);
+	}
+
+	ck_assert_ptr_ne(arena_thread(NULL), NULL);
+	roman_arena_reset(roman_thread_arena());
+}
+END_TEST
+
+//Thread function for the table test: writes the table file at "path" 
+//and returns the result.  
+static void * table_write_thread(void * path) {
+
+	return (void*)(intptr_t)roman_table_write((const char*)path);
+}
+
+//Test the precomputed result table, built in memory and mapped from a 
+//file.  
+START_TEST(roman_table_test) {
+
+	const char * path = "test_roman_table.bin";
+
+	roman_table * built = roman_table_build();
+	ck_assert_ptr_ne(built, NULL);
+	ck_assert_int_eq(roman_table_write(path), 0);
+
+	roman_table * opened = roman_table_open(path);
+	ck_assert_ptr_ne(opened, NULL);
+
+	char * numeral_a = allocate_roman_numeral_string();
+	char * numeral_b = allocate_roman_numeral_string();
+	char * expected = allocate_roman_numeral_string();
+	char * result = allocate_roman_numeral_string();
+
+	//Every numeral is in both tables.  
+	for(int i=MIN_DECIMAL; i<=MAX_DECIMAL; i++) {
+
+		convert_decimal_to_roman(i, expected);
+		ck_assert_str_eq(roman_table_numeral(built, i), expected);
+		ck_assert_str_eq(roman_table_numeral(opened, i), expected);
+	}
+
+	ck_assert_ptr_eq(roman_table_numeral(built, 0), NULL);
+	ck_assert_ptr_eq(roman_table_numeral(opened, 4000), NULL);
+
+	//Random operations give the same results as the compute path.  
+	srand(38);
+	for(int i=0; i<10000; i++) {
+
+		int decimal_a = rand() % MAX_DECIMAL + 1;
+		int decimal_b = rand() % MAX_DECIMAL + 1;
+		roman_table * table = i % 2 ? built : opened;
+
+		convert_decimal_to_roman(decimal_a, numeral_a);
+		convert_decimal_to_roman(decimal_b, numeral_b);
+
+		int expected_failure = roman_addition(numeral_a, numeral_b, expected);
+		ck_assert_int_eq(roman_table_addition(table, numeral_a, numeral_b, result), expected_failure);
+		if(!expected_failure) {
+			ck_assert_str_eq(result, expected);
+		}
+
+		expected_failure = roman_subtraction(numeral_a, numeral_b, expected);
+		ck_assert_int_eq(roman_table_subtraction(table, numeral_a, numeral_b, result), expected_failure);
+		if(!expected_failure) {
+			ck_assert_str_eq(result, expected);
+		}
+	}
+
+	ck_assert_int_eq(roman_table_addition(opened, "IIII", "I", result), 1);
+
+	//Only the numeral and its null character are written.  
+	char exact[sizeof("VIII") + 1];
+	memset(exact, '#', sizeof(exact));
+	ck_assert_int_eq(roman_table_addition(opened, "V", "III", exact), 0);
+	ck_assert_str_eq(exact, "VIII");
+	ck_assert_int_eq(exact[sizeof("VIII")], '#');
+	ck_assert_int_eq(roman_table_addition(NULL, "I", "I", result), 1);
+
+	roman_table_close(opened);
+	roman_table_close(built);
+	roman_table_close(NULL);
+
+	//A corrupted file is rejected.  
+	FILE * file = fopen(path, "r+b");
+	fseek(file, sizeof(roman_table_header) + 14 * ROMAN_NUMERAL_SIZE + 10, SEEK_SET);
+	fputc('X', file);
+	fclose(file);
+	ck_assert_ptr_eq(roman_table_open(path), NULL);
+
+	//Concurrent writers of the same file each write their own 
+	//temporary file, and the table left in place is valid.  
+	pthread_t threads[4];
+	void * written[4];
+
+	for(int i=0; i<4; i++) {
+		pthread_create(&threads[i], NULL, table_write_thread, (void*)path);
+	}
+
+	for(int i=0; i<4; i++) {
+		pthread_join(threads[i], &written[i]);
+		ck_assert_int_eq((intptr_t)written[i], 0);
+	}
+
+	opened = roman_table_open(path);
+	ck_assert_ptr_ne(opened, NULL);
+	roman_table_close(opened);
+
+	remove(path);
+	ck_assert_ptr_eq(roman_table_open(path), NULL);
+
+	free(result);
+	free(expected);
+	free(numeral_b);
+	free(numeral_a);
+}
+END_TEST
+
+//Results gathered by the pipeline test's callback.  While "hold" is 
+//set the callback waits, stalling the pipeline.  
+typedef struct {
+	roman_pipeline_output * outputs;
+	size_t count;
+	int hold;
+} pipeline_results;
+
+//Callback for the pipeline test.  
+static void pipeline_result(const roman_pipeline_output * outputs, size_t count, void * context) {
+
+	pipeline_results * results = (pipeline_results*)context;
+
+	while(__atomic_load_n(&results->hold, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+
+	memcpy(results->outputs + results->count, outputs, count * sizeof(roman_pipeline_output));
+	results->count += count;
+}
+
+//Test the pipelined arithmetic engine.  
+START_TEST(roman_pipeline_test) {
+
+	const size_t count = 10000;
+	roman_pipeline_input * records = malloc(sizeof(roman_pipeline_input) * count);
+	pipeline_results results = {malloc(sizeof(roman_pipeline_output) * count), 0, 0};
+	char * expected = allocate_roman_numeral_string();
+
+	ck_assert_ptr_eq(roman_pipeline_start(NULL, NULL, NULL), NULL);
+
+	//Random operations, with some invalid operands.  
+	srand(39);
+	for(size_t i=0; i<count; i++) {
+
+		memset(&records[i], 0, sizeof(roman_pipeline_input));
+		convert_decimal_to_roman(rand() % MAX_DECIMAL + 1, records[i].numeral_a);
+		convert_decimal_to_roman(rand() % MAX_DECIMAL + 1, records[i].numeral_b);
+		records[i].operation = rand() % 2 ? ROMAN_PIPELINE_ADD : ROMAN_PIPELINE_SUBTRACT;
+
+		if(i % 97 == 0) {
+			strcpy(records[i].numeral_b, "IIII");
+		}
+	}
+
+	//Submit in uneven pieces with a small batch size, so batches are 
+	//split across calls, then check every result in order.  
+	roman_pipeline_config config = {100, 2, ROMAN_PIPELINE_BLOCK};
+	roman_pipeline * pipeline = roman_pipeline_start(&config, pipeline_result, &results);
+	ck_assert_ptr_ne(pipeline, NULL);
+
+	size_t accepted;
+	for(size_t i=0; i<count; i+=333) {
+
+		size_t piece = count - i < 333 ? count - i : 333;
+		ck_assert_int_eq(roman_pipeline_submit(pipeline, records + i, piece, &accepted), 0);
+		ck_assert_int_eq(accepted, piece);
+	}
+
+	roman_pipeline_flush(pipeline);
+	ck_assert_int_eq(roman_pipeline_finish(pipeline), 0);
+	ck_assert_int_eq(results.count, count);
+
+	for(size_t i=0; i<count; i++) {
+
+		int expected_failure = records[i].operation == ROMAN_PIPELINE_ADD
+			? roman_addition(records[i].numeral_a, records[i].numeral_b, expected)
+			: roman_subtraction(records[i].numeral_a, records[i].numeral_b, expected);
+
+		ck_assert_int_eq(results.outputs[i].status, expected_failure);
+		if(!expected_failure) {
+			ck_assert_str_eq(results.outputs[i].numeral, expected);
+		}
+		else {
+			ck_assert_str_eq(results.outputs[i].numeral, "");
+		}
+	}
+
+	//With rejecting backpressure, a stalled pipeline stops accepting 
+	//records, and every accepted record is still delivered.  
+	config.batch_size = 4;
+	config.queue_batches = 1;
+	config.backpressure = ROMAN_PIPELINE_REJECT;
+	results.count = 0;
+	results.hold = 1;
+
+	pipeline = roman_pipeline_start(&config, pipeline_result, &results);
+	ck_assert_ptr_ne(pipeline, NULL);
+	ck_assert_int_eq(roman_pipeline_submit(pipeline, records, count, &accepted), 1);
+	ck_assert(accepted < count);
+
+	__atomic_store_n(&results.hold, 0, __ATOMIC_RELEASE);
+	ck_assert_int_eq(roman_pipeline_finish(pipeline), 0);
+	ck_assert_int_eq(results.count, accepted);
+
+	//An empty stream finishes cleanly.  
+	results.count = 0;
+	pipeline = roman_pipeline_start(NULL, pipeline_result, &results);
+	ck_assert_int_eq(roman_pipeline_finish(pipeline), 0);
+	ck_assert_int_eq(results.count, 0);
+	ck_assert_int_eq(roman_pipeline_finish(NULL), 1);
+
+	free(expected);
+	free(results.outputs);
+	free(records);
+}
+END_TEST
+
 /* This function creates the test Suite structure, with the test cases 
 added to it.  The test suite is then run within the main function.  */
 static Suite *create_test_suite(void) {
@@ -429,6 +1455,39 @@ static Suite *create_test_suite(void) {
 	//Add the test for the subtraction function.
 	tcase_add_test(tc_core, roman_subtraction_test);
 
+	//Add the test for the running total accumulator.
+	tcase_add_test(tc_core, roman_accumulator_test);
+
+	//Add the test for the streaming parser.
+	tcase_add_test(tc_core, roman_stream_test);
+
+	//Add the test for the text scanner.
+	tcase_add_test(tc_core, roman_scan_test);
+
+	//Add the test for the sequence generator.
+	tcase_add_test(tc_core, roman_sequence_test);
+
+	//Add the test for the interning table.
+	tcase_add_test(tc_core, roman_intern_test);
+
+	//Add the test for the column-wise arithmetic.
+	tcase_add_test(tc_core, roman_columns_test);
+
+	//Add the test for the rejection of oversized input.
+	tcase_add_test(tc_core, roman_bounded_input_test);
+
+	//Add the test of every short string of Roman numeral symbols.
+	tcase_add_test(tc_core, exhaustive_parse_test);
+
+	//Add the test for the numeral buffer arena.
+	tcase_add_test(tc_core, roman_arena_test);
+
+	//Add the test for the precomputed result table.
+	tcase_add_test(tc_core, roman_table_test);
+
+	//Add the test for the pipelined arithmetic engine.
+	tcase_add_test(tc_core, roman_pipeline_test);
+
 	//Add the test case to the tese suite.  
 	suite_add_tcase(s, tc_core);
 